@@ -0,0 +1,25 @@
+#pragma once
+
+#include "common.h"
+
+// Flood fill on a bitset copy of the grid: each row is a run of 64-bit words, one
+// bit per cell, with one mask per move (bit set: the move out of that cell is
+// allowed, same rules as solveBFS). The masks are rebuilt only when mazeRevision
+// changes, so repeated queries on one maze pay for them once.
+struct BitFloodResult
+{
+    bool found = false;        // target was filled
+    int distance = -1;         // steps to target, bitFloodDistance only
+    size_t reached = 0;        // cells filled when the query stopped
+    int sweeps = 0;            // layers (distance) or row passes (reachability)
+    double buildSeconds = 0.0; // mask rebuild, 0 when they were current
+    double seconds = 0.0;      // the fill itself
+};
+
+// Shortest number of steps, one sweep per BFS layer over the frontier's words
+BitFloodResult bitFloodDistance(int source, int target);
+
+// Connectivity only: every row touched is saturated along its open runs in one
+// word pass, so a sweep covers many layers. target -1 fills the whole component.
+BitFloodResult bitFloodReach(int source, int target = -1);
+bool bitFloodConnected(int source, int target);
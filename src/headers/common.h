@@ -29,6 +29,7 @@
 #include <windows.h>
 #endif
 #include <cstring>
+#include <cstdint>
 
 // STB Image
 #include "stb_image.h"
@@ -44,6 +45,7 @@ struct Cell
     bool visited = false;
     bool walls[4] = {true, true, true, true}; // top, right, bottom, left
     bool blocked = false;
+    float cost = 1.0f; // terrain: price of stepping into the cell, >= 1 (weighted solvers only)
 };
 
 extern std::vector<Cell> grid;
@@ -58,6 +60,7 @@ extern std::vector<std::tuple<int, int, bool, float>> events;
 extern std::vector<std::pair<int, int>> finalPathEdges;
 extern std::vector<float> successVertices;
 extern std::vector<float> failureVertices;
+extern size_t successSynced, failureSynced; // floats already uploaded to successVBO/failureVBO (or tiled, without them)
 extern size_t eventIndex;
 extern bool stepMode;
 
@@ -66,13 +69,19 @@ extern std::vector<float> wallVertices;
 extern unsigned int wallVAO, wallVBO, borderVAO, borderVBO;
 extern unsigned int successVAO, successVBO, failureVAO, failureVBO;
 extern int startCell, endCell;
+extern unsigned int mazeRevision; // bumped on every wall/obstacle/start-end edit
 extern std::mt19937 rng;
 extern unsigned int shader;
 extern glm::mat4 proj;
+extern float camZoom, camX, camY; // camera: zoom factor and top-left visible cell
 
 // Settings
 extern float speedMultiplier;
 extern float obstacleDensity;
+extern float terrainMaxCost; // upper end of randomizeTerrain()
+extern bool lodEnabled; // density texture instead of walls when cells are tiny
+extern bool pruneDeadEnds; // solvers skip cells sealed by the dead-end fill
+extern bool perfectMazes;  // generators skip the loop passes
 
 // Textures
 extern GLuint texWall;
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "common.h"
+
+// Connected regions of open cells. Two neighbours are joined when the wall
+// between them is open (the generators clear both sides) and neither is
+// blocked. Labels are rebuilt lazily after any edit, except single-cell obstacle
+// changes made through setCellBlocked, which update them in place.
+
+// True when the wall between neighbouring cells u and v is down on both sides;
+// obstacles are left to the caller. The generators clear both sides and loadMaze
+// closes a wall a file has on one side only, so this is the step every solver
+// takes, in either direction. The undirected indexes read edges through it.
+inline bool openBetween(int u, int v)
+{
+    int d = v == u - gCols ? 0 : v == u + 1 ? 1 : v == u + gCols ? 2 : 3;
+    return !grid[u].walls[d] && !grid[v].walls[(d + 2) % 4];
+}
+
+// Unblocked neighbours v of u with openBetween(u, v); returns how many
+int openNeighbours(int u, int out[4]);
+
+// Region id of a cell, -1 for blocked or out of range
+int componentOf(int cell);
+bool cellsConnected(int a, int b);
+int componentCount();
+int componentSize(int cell);
+
+// Full rebuild: union-find per row band in parallel, then the band seams
+void buildComponents();
+
+// Called by setCellBlocked right after it flips one cell and bumps mazeRevision.
+// Blocking may split a region: searches from the open neighbours run in lockstep
+// and only the pieces that run dry first are relabelled, so the cost is the
+// smaller side. Unblocking merges regions into the largest one.
+void componentsCellChanged(int cell);
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "common.h"
+#include "solvers.h"
+
+// Contraction hierarchy over the open cells. Cells are contracted one at a time
+// in order of edge difference (shortcuts the contraction adds minus arcs it
+// removes, plus the contracted neighbours already around it); whenever the
+// only shortest path between two of a cell's remaining neighbours runs through
+// it, a shortcut joins them directly. A query then searches from both ends
+// along arcs to later-contracted cells only, meets near the top of the
+// hierarchy after settling about a hundred cells on a million-cell maze, and
+// unpacks the shortcuts it used back into grid steps.
+//
+// Stepping into a cell costs its terrain, so the grid is directed. The
+// hierarchy is built on arcs weighing the mean cost of their two cells: that
+// prices every path between s and t at its real cost minus (cost(t) - cost(s)) / 2,
+// the same offset for all of them, so the shortest paths are the same.
+//
+// The index is for static mazes: any edit rebuilds it in full on the next query.
+struct ChInfo
+{
+    int cells = 0;         // open cells contracted
+    size_t shortcuts = 0;  // arcs that skip a contracted cell
+    size_t upArcs = 0;     // arcs kept for the queries, steps and shortcuts
+    bool loaded = false;   // read from a maze file rather than built
+    double seconds = 0.0;  // build (or load) time
+    size_t bytes = 0;
+};
+
+// Hierarchy of the current maze, built when mazeRevision moved past it
+const ChInfo &currentContraction();
+
+// True when the hierarchy matches the current maze, without building it
+bool contractionCurrent();
+
+// Cost of the cheapest a -> b path as the weighted solvers count it, infinity
+// when either cell is blocked or b is out of reach
+float chDistance(int a, int b);
+
+// Cells from a to b inclusive along that path; false (and empty) without one
+bool chPath(int a, int b, std::vector<int> &cells);
+
+// Start-end query through the hierarchy, built before the clock starts. Its
+// search moves along shortcuts, so the only events are the final path's steps.
+SolveStats solveCH();
+
+// Section of a maze file: the upward arcs of the current hierarchy, then a
+// checksum of them. Reading adopts them for the maze just loaded; both log and
+// return false on errors, and a section that fails its checksum is dropped.
+bool writeContraction(FILE *f);
+bool readContraction(FILE *f);
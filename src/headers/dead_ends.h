@@ -0,0 +1,28 @@
+#pragma once
+
+#include "common.h"
+
+// Dead-end filling: open cells with at most one open neighbour are sealed, start
+// and end excepted, until none are left. A sealed cell cannot be on any simple
+// start-end path, so solvers that skip them find the same shortest paths. In a
+// perfect maze only the start-end path survives; with loops, the cycles and the
+// routes between them do. Cells outside the start's region are sealed up front.
+struct DeadEndFill
+{
+    std::vector<uint8_t> sealed; // 1: no start-end path uses the cell
+    int openCells = 0;           // unblocked cells
+    int viableCells = 0;         // unblocked and not sealed
+    int rounds = 0;              // tile rounds (1 for the worklist)
+    double seconds = 0.0;
+};
+
+// One worklist over the whole grid
+void fillDeadEnds(DeadEndFill &out);
+
+// 64x64 tiles in parallel; a seal across a tile border is handed to the
+// neighbouring tile for the next round. Same result as fillDeadEnds.
+void fillDeadEndsTiled(DeadEndFill &out);
+
+// Fill of the current maze, redone when mazeRevision changes. runSolver hands
+// its mask to the solvers when pruneDeadEnds is set.
+const DeadEndFill &currentDeadEndFill();
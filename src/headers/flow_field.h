@@ -0,0 +1,35 @@
+#pragma once
+
+#include "common.h"
+#include "solvers.h"
+
+// Flow field toward endCell: one search backwards from the end over the whole
+// grid stores every cell's cost to reach it and, in two bits, the direction of
+// its next step. A path from any start then just follows the arrows, one step
+// per cell, with no search. Fields are kept for the last few end cells and
+// rebuilt only when walls, obstacles or terrain changed; moving the start, or
+// an edit that changes nothing (mazeRevision also moves for those), reuses
+// them. Unit-cost mazes are searched breadth-first, weighted ones by Dijkstra.
+struct FlowInfo
+{
+    int reached = 0;      // cells with a path to the end
+    double seconds = 0.0; // build time of the field
+    size_t bytes = 0;
+};
+
+// Field toward endCell, built first when it is missing or out of date
+const FlowInfo &currentFlowField();
+
+// True when a field for endCell matches the current revision, without building
+bool flowFieldCurrent();
+
+// Cost from a cell to endCell as the weighted solvers count it, infinity when
+// the end is out of reach
+float flowDistance(int from);
+
+// Cells from `from` to endCell inclusive; false (and empty) without a path
+bool flowPath(int from, std::vector<int> &cells);
+
+// Start-end path read off the field, built before the clock starts. Nothing is
+// searched, so the only events are the path's own steps.
+SolveStats solveFlowField();
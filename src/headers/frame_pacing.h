@@ -0,0 +1,15 @@
+#pragma once
+
+#include "common.h"
+
+// Idle-aware main loop: only redraw when something changed
+struct FrameStats
+{
+    float fps = 0.0f;        // frames actually rendered per second
+    float cpuPercent = 0.0f; // process CPU time / wall time over the same window
+};
+
+void installDamageCallbacks(GLFWwindow *window);
+void requestRedraw(int frames = 3);
+bool waitForFrame(bool animating);
+const FrameStats &frameStats();
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "common.h"
+#include "solvers.h"
+
+// Hierarchical A* (HPA*). The grid is cut into HPA_CLUSTER x HPA_CLUSTER
+// clusters. Along each cluster border, a run of neighbouring cells that are
+// open across the border and to each other along it is one entrance; the pair
+// of cells in its middle, or at both ends of a long run, become nodes of the
+// abstract graph. Every
+// cluster stores the cost between each pair of its nodes, searched without
+// leaving the cluster. A query links start and end to the nodes of their
+// clusters, runs A* over the abstract graph and then searches cell by cell only
+// inside the clusters the abstract path crosses. Paths are near-shortest: an
+// entrance squeezed to one or two crossings can add a detour.
+#define HPA_CLUSTER 32
+
+struct HpaInfo
+{
+    int clusters = 0;
+    int nodes = 0;          // entrance cells
+    size_t intraEdges = 0;  // node pairs with a path inside their cluster
+    int rebuilt = 0;        // clusters redone by the last update
+    double seconds = 0.0;   // time of the last update (full or partial)
+    size_t bytes = 0;
+};
+
+// Abstraction of the current maze: rebuilt in full when mazeRevision moved past
+// it, or only for the clusters hpaCellChanged marked
+const HpaInfo &currentHpa();
+
+// Called by setCellBlocked right after a cell's obstacle flag changes and
+// mazeRevision is bumped. Marks the cell's cluster, and the one across any border
+// it lies on, for the next update. Wall edits have no hook: like every other
+// edit they move mazeRevision on, and the next update rebuilds in full.
+void hpaCellChanged(int cell);
+
+// Shortest-ish start-end path through the abstraction; the update itself is
+// done before the clock starts. Events cover the cell-level refinement searches.
+SolveStats solveHPA();
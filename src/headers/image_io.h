@@ -0,0 +1,19 @@
+#pragma once
+
+#include "common.h"
+
+// Palette (8-bit indexed) image writers for the headless renderer.
+// Palette entries are 0xRRGGBB.
+bool writePng(const char *path, int w, int h, const std::vector<uint8_t> &px,
+              const uint32_t *palette, int paletteSize);
+
+// Animated GIF: frames are cropped to the rectangle that changed since the last one
+struct GifWriter
+{
+    FILE *f = nullptr;
+    int w = 0, h = 0, depth = 2; // depth: log2 of the color table size
+    std::vector<uint8_t> prev;
+    bool open(const char *path, int width, int height, const uint32_t *palette, int paletteSize);
+    void addFrame(const std::vector<uint8_t> &px, int delayCs);
+    bool close();
+};
@@ -2,7 +2,42 @@
 
 #include "common.h"
 
-// Logging functions
+// Numeric levels for the preprocessor, which cannot see enum values
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_ERROR 3
+
+// Severity levels. logf() logs at LL_INFO.
+enum LogLevel
+{
+    LL_DEBUG = LOG_LEVEL_DEBUG,
+    LL_INFO = LOG_LEVEL_INFO,
+    LL_WARN = LOG_LEVEL_WARN,
+    LL_ERROR = LOG_LEVEL_ERROR
+};
+
+// Levels below this are compiled out entirely (debug logs vanish from release
+// builds). Override with -DLOG_COMPILE_LEVEL=LOG_LEVEL_WARN and the like.
+#ifndef LOG_COMPILE_LEVEL
+#ifdef NDEBUG
+#define LOG_COMPILE_LEVEL LOG_LEVEL_INFO
+#else
+#define LOG_COMPILE_LEVEL LOG_LEVEL_DEBUG
+#endif
+#endif
+
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_DEBUG
+#define logDebug(...) logAt(LL_DEBUG, __VA_ARGS__)
+#else
+#define logDebug(...) ((void)0)
+#endif
+
+// Logging functions. Messages are formatted by the caller and handed to a
+// background writer thread; each call site (format string) is rate limited.
 void open_log();
+void close_log();
+void setLogLevel(LogLevel minLevel);
+void logAt(LogLevel level, const char *fmt, ...);
 void logf(const char *fmt, ...);
-[[noreturn]] void fatal(const char *fmt, ...);
\ No newline at end of file
+[[noreturn]] void fatal(const char *fmt, ...);
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "common.h"
+#include "solvers.h"
+
+// Lifelong Planning A* (LPA*) from startCell to endCell. Every cell keeps g,
+// the cost of its best path found so far, and rhs, the cheapest g of a
+// neighbour plus the step; cells where the two differ sit in the queue. The
+// state outlives the solve: the next one compares the grid with the copy it
+// last planned on, recomputes rhs only around the cells whose walls, obstacle
+// or terrain changed, and expands just the cells those changes reach. Moving
+// the start or end, resizing the grid, or changing more than an eighth of the
+// cells plans from scratch (then it expands about what A* does).
+struct LpaInfo
+{
+    bool fresh = false;   // the last solve started over
+    int changedCells = 0; // cells repaired by the last solve
+    double seconds = 0.0;
+};
+
+const LpaInfo &lastLpa();
+
+// Drops the state so the next solve plans from scratch
+void resetLpa();
+
+// Called right after a cell's obstacle flag changes and mazeRevision is
+// bumped: queues the cell so the next solve skips comparing the whole grid
+void lpaCellChanged(int cell);
+
+// Shortest start-end path, repaired from the previous solve's state. Events
+// cover the cells the repair expanded, so an edit far from the path shows few.
+SolveStats solveLPA();
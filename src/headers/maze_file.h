@@ -0,0 +1,18 @@
+#pragma once
+
+#include "common.h"
+
+// Binary maze files in the machine's byte order: a header (magic "MAZE",
+// version, columns, rows, start, end), one flag byte per cell (walls in bits
+// 0-3, obstacle in bit 4), one float of terrain cost per cell, then optional
+// sections, each a 4-byte tag and a 64-bit payload size so readers skip tags
+// they do not know. saveMaze adds the contraction hierarchy as section "CHIX"
+// when one is built for the maze; loadMaze adopts it if the grid checksum
+// stored in front of it still matches and the section's own checksum, stored
+// after it, shows it undamaged. Otherwise it is rebuilt on the next query.
+// loadMaze closes any wall the file sets on one side of a pair only.
+bool saveMaze(const char *path);
+bool loadMaze(const char *path);
+
+// FNV-1a over the walls, obstacles and terrain of every cell
+uint64_t mazeChecksum();
@@ -23,5 +23,8 @@ void generatePrim();
 void generateKruskal();
 void pickStartEnd();
 void randomizeObstacles(float density);
+void setCellBlocked(int cell, bool blocked);
 void clearObstacles();
+void randomizeTerrain(float maxCost);
+void clearTerrain();
 void regenerateMaze();
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "common.h"
+
+// Structural summary of the current grid, for comparing generators. Two cells are
+// connected when the wall between them is open and neither is blocked, so the
+// numbers reflect loops from addMazeComplexity/ensureMultiplePathways and
+// obstacles. A corridor is a chain of degree-2 cells between two cells of other
+// degree (dead ends, junctions); its length is counted in edges.
+static const int METRIC_HIST_BUCKETS = 24;
+
+struct MazeMetrics
+{
+    int openCells = 0;
+    int degreeCount[5] = {}; // open cells by number of open neighbours
+    long long edges = 0;
+    int deadEnds = 0;  // degree 1
+    int junctions = 0; // degree 3 and 4
+    int corridors = 0;
+    int longestCorridor = 0;
+    double meanCorridor = 0.0;
+    int corridorHist[METRIC_HIST_BUCKETS] = {}; // bucket b: lengths in [2^b, 2^(b+1))
+    // From a BFS over the start cell's component (only with distances requested)
+    int reachable = 0;          // open cells connected to start
+    long long loops = 0;        // independent cycles there: edges - (reachable - 1)
+    int startEccentricity = -1; // farthest reachable cell from start, in steps
+    int endDistance = -1;       // shortest start-end path in steps, -1 if cut off
+    double seconds = 0.0;
+};
+
+// Band-parallel pass for the counts and corridors, plus a parallel BFS from
+// startCell when withDistances is set
+MazeMetrics computeMazeMetrics(bool withDistances = true);
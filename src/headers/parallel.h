@@ -0,0 +1,7 @@
+#pragma once
+
+#include "common.h"
+
+// Small persistent worker pool shared by the CPU-heavy batch paths
+int workerCount();
+void parallelFor(int count, const std::function<void(int)> &fn);
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "common.h"
+
+// Whole-grid BFS from one cell with the same moves as solveBFS (open wall on the
+// current cell, neighbour not blocked). dist is -1 where unreachable; parent is
+// -1 there and at the source.
+struct BfsField
+{
+    std::vector<int> dist, parent;
+    int levels = 0;         // distinct distances, eccentricity of the source + 1
+    size_t reached = 0;     // cells with dist >= 0
+    int bottomUpLevels = 0; // levels the parallel version expanded bottom-up
+    double seconds = 0.0;
+};
+
+// Reference: plain queue BFS, neighbours in solveBFS order (top, right, bottom, left)
+void bfsFieldSequential(int source, BfsField &out);
+
+// Level-synchronous over parallelFor, switching between top-down and bottom-up
+// expansion by frontier size. Distances and parents are identical to
+// bfsFieldSequential: each cell keeps the (frontier position, direction) edge the
+// queue version would have taken first.
+void bfsFieldParallel(int source, BfsField &out);
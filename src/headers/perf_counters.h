@@ -0,0 +1,31 @@
+#pragma once
+
+#include "common.h"
+
+// Hardware counters for the benchmark harness (Linux perf_event_open). Counters
+// follow the calling thread only, so they cover the single-threaded generators
+// and solvers but not work handed to parallelFor. Any counter the kernel or CPU
+// refuses is reported as unavailable instead of failing the run.
+enum PerfCounter
+{
+    PC_CYCLES,
+    PC_INSTRUCTIONS,
+    PC_L1D_MISSES, // L1 data read misses
+    PC_LLC_MISSES, // last-level cache misses
+    PC_BRANCH_MISSES,
+    PC_COUNT
+};
+extern const char *const perfCounterNames[PC_COUNT];
+
+struct PerfSample
+{
+    uint64_t value[PC_COUNT] = {}; // scaled up when the kernel multiplexed counters
+    bool valid[PC_COUNT] = {};
+    int runs[PC_COUNT] = {}; // samples summed into each value, only those that read it
+    void add(const PerfSample &o);
+};
+
+int perfOpen(); // number of counters available; logs why the others are not
+void perfStart();
+PerfSample perfStop();
+void perfClose();
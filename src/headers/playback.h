@@ -0,0 +1,13 @@
+#pragma once
+
+#include "common.h"
+
+// Seekable solve playback. Every success push is a node in a tree whose parent is
+// the segment below it on the success stack (DFS backtracks pop back to the parent),
+// so the drawn success path at any event index is the root-to-top path of one node.
+void buildPlaybackTimeline();
+void invalidatePlayback();
+bool playbackReady();
+bool playbackCanResume();
+void applyNextEvent();
+void seekPlayback(size_t target);
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "common.h"
+
+// Per-phase frame profiler shown in the sidebar. All calls are a single branch
+// while profilerEnabled is false (the panel is collapsed). While traceEnabled is
+// set, each frame and phase is also recorded as a trace scope.
+enum ProfPhase
+{
+    PROF_LAYER,        // camera + background/static layer (incl. FBO redraws)
+    PROF_WALLS,        // wall submission; GPU time is the instanced draw callback
+    PROF_PATHS,        // exploration lines; GPU time is the path draw callback
+    PROF_UI,           // sidebar widgets and outer background
+    PROF_IMGUI_RENDER, // ImGui::Render
+    PROF_GL_RENDER,    // ImGui_ImplOpenGL3_RenderDrawData (contains the callbacks)
+    PROF_COUNT
+};
+
+extern bool profilerEnabled;
+
+void profFrameBegin();
+void profFrameEnd(const ImDrawData *drawData);
+void profBegin(ProfPhase p);
+void profEnd(ProfPhase p);
+void profGpuBegin(ProfPhase p);
+void profGpuEnd(ProfPhase p);
+void drawProfilerPanel();
+void deleteProfiler();
@@ -5,11 +5,19 @@
 // Drawing and rendering functions
 void framebuffer_size_callback(GLFWwindow *, int width, int height);
 void buildProjection();
+void computeMazeSquare(float &sx, float &sy, int &sz);
 void computeViewportAndCell(float &xoff, float &yoff, float &cell, int &sz);
+void visibleCellRange(int &x0, int &y0, int &x1, int &y1);
+int cellUnderMouse();
+void updateCamera();
+void resetCamera();
 void drawTexturedLayer();
 void drawWallsAsLines();
 void drawPathsAsLines();
+int currentLodLevel();
 void buildWallVertices();
+void initRenderBuffers();
+void deleteRenderBuffers();
 void rebuildBorderVAO();
 void drawSplashScreen();
 void updateSplashScreen();
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "common.h"
+
+// CPU rasterizer for the maze and solve overlay, for headless thumbnails and
+// animations. Draws from the same data as the GUI (grid, events, finalPathEdges)
+// into an 8-bit indexed image using renderPalette.
+enum RenderColor : uint8_t
+{
+    RC_FLOOR,
+    RC_WALL,
+    RC_OBSTACLE,
+    RC_START,
+    RC_END,
+    RC_FAILURE,
+    RC_SUCCESS,
+    RC_PATH,
+    RC_COUNT
+};
+extern const uint32_t renderPalette[RC_COUNT];
+
+// Exploration overlay after the first `applied` events: 4 direction bits per cell
+// (top, right, bottom, left, like Cell::walls). Advances forward incrementally so
+// consecutive animation frames only pay for the new events.
+struct OverlayState
+{
+    std::vector<uint8_t> success, failure, path;
+    std::vector<std::pair<int, int>> stack; // DFS success stack for backtrack erasure
+    size_t applied = 0;
+    bool popOnFailure = false;
+    void reset();
+    void advanceTo(size_t eventCount);
+    void showPath(bool show); // highlight finalPathEdges
+};
+
+struct SoftwareImage
+{
+    int w = 0, h = 0;
+    std::vector<uint8_t> px;
+};
+
+void renderMazeFrame(SoftwareImage &img, int width, const OverlayState &overlay);
@@ -2,12 +2,31 @@
 
 #include "common.h"
 
+// Real cost of one solve, independent of the animation speed
+struct SolveStats
+{
+    double seconds = 0.0;      // wall-clock time of the search (including event recording)
+    size_t nodesExpanded = 0;  // nodes taken off the stack/queue/heap and expanded
+    size_t edgesRelaxed = 0;   // edges that discovered a node or improved its distance
+    size_t peakFrontier = 0;   // largest stack/queue/open-list size
+    size_t stalePops = 0;      // heap entries skipped because a better one was already popped
+    size_t pathLength = 0;     // edges from start to end, 0 when unreachable
+    size_t scratchBytes = 0;   // search-local memory (visited/parent/distance arrays, frontier)
+};
+
+#define SOLVER_COUNT 9
+extern const char *const solverNames[SOLVER_COUNT];
+
 // Pathfinding solver functions
 void resetAnimationBuffers();
 void pushEvent(int u, int v, bool ok, float wCost = 1.0f);
 void pushSuccess(int u, int v);
 void pushFailure(int u, int v);
-void solveDFS();
-void solveBFS();
-void solveDijkstra();
-void solveAStar();
\ No newline at end of file
+void popSuccess();
+SolveStats solveDFS();
+SolveStats solveBFS();
+SolveStats solveDijkstra();
+SolveStats solveAStar();
+SolveStats solveDeltaStepping(); // parallel, same distances as solveDijkstra
+SolveStats runSolver(int algo);
+void measureAllSolvers(SolveStats out[SOLVER_COUNT]);
\ No newline at end of file
@@ -2,7 +2,33 @@
 
 #include "common.h"
 
+// Every image in assets/ that the UI draws lives in one atlas texture
+enum AtlasSprite
+{
+    SPR_SPLASH,
+    SPR_BACKGROUND,
+    SPR_START,
+    SPR_END,
+    SPR_OBSTACLE,
+    SPR_LINE_HORI,
+    SPR_LINE_VERTI,
+    SPR_PLAY,
+    SPR_PAUSE,
+    SPR_REGEN,
+    SPR_SETTINGS,
+    SPR_STEP,
+    SPR_COUNT
+};
+
+struct AtlasRect
+{
+    ImVec2 uv0 = ImVec2(0, 0), uv1 = ImVec2(1, 1);
+};
+
+extern GLuint texAtlas;
+extern AtlasRect atlasRects[SPR_COUNT];
+
 // Texture loading functions
 GLuint loadTexture(const char *path);
 void loadAllTextures();
-void deleteAllTextures();
\ No newline at end of file
+void deleteAllTextures();
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "common.h"
+#include <atomic>
+
+// Chrome trace-event recorder (chrome://tracing, ui.perfetto.dev). Each thread
+// appends to its own buffer; nothing is recorded while traceEnabled is false.
+// Names must be string literals or otherwise outlive the trace.
+extern std::atomic<bool> traceEnabled;
+
+void traceBegin(const char *name);
+void traceEnd(const char *name);
+void traceCounter(const char *name, double value);
+void traceThreadName(const char *name); // label for the calling thread's track
+void traceClear();
+size_t traceEventCount();
+bool writeTrace(const char *path);
+
+// Begin/end pair for a C++ scope. Remembers whether the begin was recorded so
+// toggling tracing mid-scope never leaves an unmatched end.
+struct TraceScope
+{
+    const char *name;
+    bool active;
+    explicit TraceScope(const char *n) : name(n), active(traceEnabled.load(std::memory_order_relaxed))
+    {
+        if (active)
+            traceBegin(name);
+    }
+    ~TraceScope()
+    {
+        if (active)
+            traceEnd(name);
+    }
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+};
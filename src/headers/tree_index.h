@@ -0,0 +1,42 @@
+#pragma once
+
+#include "common.h"
+
+// Point-to-point distances through a spanning tree of the start's region. The
+// tree is the BFS tree from the root (startCell, or the first open cell), laid
+// out as an Euler tour with a sparse table over its depths, so the lowest common
+// ancestor of two cells, and with it their tree distance, is two table reads.
+//
+// A perfect maze is its own spanning tree and every answer is exact. Each loop
+// edge adds two endpoints; while those fit the landmark budget, a BFS field from
+// every endpoint corrects the tree distance (a shortest path that leaves the tree
+// passes a loop endpoint) and answers stay exact. The budget shrinks as the grid
+// grows: thousands of landmarks on small mazes, 32 on a million cells. Past it
+// the tree path is still a real path, but only an upper bound.
+struct TreeIndexInfo
+{
+    int root = -1;
+    int cells = 0;     // cells in the tree
+    int loopEdges = 0; // open edges between tree cells that the tree does not use
+    int landmarks = 0; // loop endpoints with a BFS field, 0 past the budget
+    int budget = 0;    // most landmarks the grid size allows
+    int levels = 0;    // sparse table rows
+    bool exact = false;
+    size_t bytes = 0;
+    double seconds = 0.0;
+};
+
+// Index of the current maze, rebuilt when mazeRevision changes; the queries below
+// call it themselves
+const TreeIndexInfo &currentTreeIndex();
+
+// Lowest common ancestor in the tree, -1 when either cell is outside it
+int treeLca(int a, int b);
+
+// Steps from a to b: exact when info.exact, otherwise the tree path's length.
+// -1 when either cell is outside the tree.
+int treeDistance(int a, int b);
+
+// Cells from a to b inclusive, along the path treeDistance measured; false (and
+// empty) when either cell is outside the tree
+bool treePath(int a, int b, std::vector<int> &cells);
@@ -0,0 +1,672 @@
+// Headless entry point: generates and solves a maze without a window and writes
+// PNG frames or an animated GIF with the software renderer. Links only the CPU
+// modules, so it runs on machines without a display or OpenGL.
+#include "headers/common.h"
+#include "headers/logging.h"
+#include "headers/maze_generation.h"
+#include "headers/solvers.h"
+#include "headers/software_render.h"
+#include "headers/image_io.h"
+#include "headers/parallel.h"
+#include "headers/tracing.h"
+#include "headers/perf_counters.h"
+#include "headers/maze_metrics.h"
+#include "headers/parallel_bfs.h"
+#include "headers/bit_flood.h"
+#include "headers/components.h"
+#include "headers/dead_ends.h"
+#include "headers/tree_index.h"
+#include "headers/hpa.h"
+#include "headers/contraction.h"
+#include "headers/lpa.h"
+#include "headers/flow_field.h"
+#include "headers/maze_file.h"
+#include <chrono>
+#include <string>
+
+static double nowSeconds()
+{
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+static void usage()
+{
+    fprintf(stderr,
+            "usage: MazeRender [options]\n"
+            "  --cols N --rows N     grid size (default 64x64)\n"
+            "  --gen ALGO            backtracker | prim | kruskal (default backtracker)\n"
+            "  --solve ALGO          dfs | bfs | dijkstra | astar | delta | hpa | ch | lpa | flow | none (default astar)\n"
+            "  --terrain MAX         random terrain costs in [1, MAX] for the weighted solvers\n"
+            "  --obstacles D         Random Obstacles at density D: block every start-end path or none\n"
+            "  --prune               solvers skip cells sealed by dead-end filling\n"
+            "  --perfect             generators keep the spanning tree (no loop passes)\n"
+            "  --seed N              RNG seed (default: random)\n"
+            "  --load FILE           read the maze (and any saved hierarchy) instead of generating one\n"
+            "  --save FILE           write the maze, with the contraction hierarchy when one was built\n"
+            "  --width PX            image width, height follows the aspect (default 1024)\n"
+            "  --png FILE            write one frame\n"
+            "  --at N                events applied in the PNG frame (default: all)\n"
+            "  --gif FILE            write an animation of the solve\n"
+            "  --every N             events per GIF frame (default: events / 100)\n"
+            "  --delay CS            GIF frame delay in 1/100 s (default 4)\n"
+            "  --path                highlight the final path on the last frame\n"
+            "  --bench N             time every generator and solver over N runs\n"
+            "  --perf                add hardware counters to --bench (Linux perf_event)\n"
+            "  --metrics             print dead ends, degrees, corridors, loops and distances\n"
+            "  --queries N           N random point-to-point distances through the tree index\n"
+            "  --ch-queries N        N random point-to-point costs through the contraction hierarchy\n"
+            "  --flow-queries N      N random starts routed to the end through its flow field\n"
+            "  --trace FILE          write a Chrome trace (chrome://tracing, Perfetto) of the run\n");
+}
+
+// Counters averaged per unit of work (cell generated / node expanded) over the
+// runs that read them, plus IPC
+static void printPerfRow(const char *name, const PerfSample &s, double unitsPerRun)
+{
+    auto perRun = [&](int c) { return (double)s.value[c] / s.runs[c]; };
+    printf("%-12s", name);
+    for (int c = 0; c < PC_COUNT; ++c)
+    {
+        if (s.valid[c])
+            printf(" %13.2f", perRun(c) / std::max(unitsPerRun, 1.0));
+        else
+            printf(" %13s", "n/a");
+    }
+    if (s.valid[PC_CYCLES] && s.valid[PC_INSTRUCTIONS] && s.value[PC_CYCLES])
+        printf(" %6.2f\n", perRun(PC_INSTRUCTIONS) / perRun(PC_CYCLES));
+    else
+        printf(" %6s\n", "n/a");
+}
+
+static void printPerfHeader(const char *what, const char *unit)
+{
+    printf("%-12s", what);
+    for (int c = 0; c < PC_COUNT; ++c)
+    {
+        char h[32];
+        snprintf(h, sizeof(h), "%s/%s", perfCounterNames[c], unit);
+        printf(" %13s", h);
+    }
+    printf(" %6s\n", "IPC");
+}
+
+static int pickName(const char *s, const char *const *names, int n)
+{
+    for (int i = 0; i < n; ++i)
+        if (!strcmp(s, names[i]))
+            return i;
+    return atoi(s);
+}
+
+int main(int argc, char **argv)
+{
+    static const char *const genNames[] = {"backtracker", "prim", "kruskal"};
+    static const char *const solveNames[] = {"dfs", "bfs", "dijkstra", "astar", "delta", "hpa", "ch", "lpa", "flow"};
+    int width = 1024, delay = 4;
+    long long at = -1, every = 0;
+    int benchRuns = 0;
+    long long queries = 0, chQueries = 0, flowQueries = 0;
+    float terrain = 0.0f, obstacles = -1.0f;
+    bool showPath = false, solve = true, perf = false, metrics = false;
+    const char *pngPath = nullptr, *gifPath = nullptr, *tracePath = nullptr;
+    const char *loadPath = nullptr, *savePath = nullptr;
+    solveAlgo = 3;
+    gCols = gRows = 64;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string a = argv[i];
+        const char *v = i + 1 < argc ? argv[i + 1] : nullptr;
+        auto needs = [&]()
+        {
+            if (!v)
+            {
+                usage();
+                fatal("missing value for %s", a.c_str());
+            }
+            ++i;
+            return v;
+        };
+        if (a == "--cols")
+            gCols = std::max(2, atoi(needs()));
+        else if (a == "--rows")
+            gRows = std::max(2, atoi(needs()));
+        else if (a == "--gen")
+            genAlgo = pickName(needs(), genNames, 3);
+        else if (a == "--solve")
+        {
+            const char *s = needs();
+            solve = strcmp(s, "none") != 0;
+            solveAlgo = pickName(s, solveNames, SOLVER_COUNT);
+        }
+        else if (a == "--terrain")
+            terrain = (float)atof(needs());
+        else if (a == "--obstacles")
+            obstacles = (float)atof(needs());
+        else if (a == "--seed")
+            rng.seed((unsigned)strtoul(needs(), nullptr, 10));
+        else if (a == "--width")
+            width = std::max(16, atoi(needs()));
+        else if (a == "--png")
+            pngPath = needs();
+        else if (a == "--at")
+            at = atoll(needs());
+        else if (a == "--gif")
+            gifPath = needs();
+        else if (a == "--every")
+            every = std::max(1LL, atoll(needs()));
+        else if (a == "--delay")
+            delay = std::max(1, atoi(needs()));
+        else if (a == "--path")
+            showPath = true;
+        else if (a == "--bench")
+            benchRuns = std::max(1, atoi(needs()));
+        else if (a == "--perf")
+            perf = true;
+        else if (a == "--metrics")
+            metrics = true;
+        else if (a == "--prune")
+            pruneDeadEnds = true;
+        else if (a == "--perfect")
+            perfectMazes = true;
+        else if (a == "--queries")
+            queries = std::max(1LL, atoll(needs()));
+        else if (a == "--ch-queries")
+            chQueries = std::max(1LL, atoll(needs()));
+        else if (a == "--flow-queries")
+            flowQueries = std::max(1LL, atoll(needs()));
+        else if (a == "--load")
+            loadPath = needs();
+        else if (a == "--save")
+            savePath = needs();
+        else if (a == "--trace")
+            tracePath = needs();
+        else
+        {
+            usage();
+            return a == "--help" || a == "-h" ? 0 : 2;
+        }
+    }
+    if (!pngPath && !gifPath && !benchRuns && !metrics && !queries && !chQueries && !flowQueries && !savePath)
+    {
+        usage();
+        return 2;
+    }
+
+    traceThreadName("main");
+    traceEnabled = tracePath != nullptr;
+
+    double t0 = nowSeconds();
+    if (loadPath)
+    {
+        if (!loadMaze(loadPath))
+            return 1;
+    }
+    else
+    {
+        regenerateMaze();
+        if (terrain > 1.0f)
+            randomizeTerrain(terrain);
+        if (obstacles >= 0.0f)
+            randomizeObstacles(obstacles);
+    }
+    double t1 = nowSeconds();
+    if (solve)
+        runSolver(solveAlgo);
+    double t2 = nowSeconds();
+    logf("%dx%d maze in %.3fs, %zu events in %.3fs, %d threads",
+         gCols, gRows, t1 - t0, events.size(), t2 - t1, workerCount());
+
+    if (metrics)
+    {
+        MazeMetrics mm = computeMazeMetrics();
+        printf("open cells %d, edges %lld, dead ends %d, junctions %d (metrics in %.3f ms)\n",
+               mm.openCells, mm.edges, mm.deadEnds, mm.junctions, mm.seconds * 1000.0);
+        printf("degree 0..4: %d %d %d %d %d\n", mm.degreeCount[0], mm.degreeCount[1],
+               mm.degreeCount[2], mm.degreeCount[3], mm.degreeCount[4]);
+        printf("corridors %d, mean length %.2f, longest %d\n", mm.corridors, mm.meanCorridor, mm.longestCorridor);
+        for (int b = 0; b < METRIC_HIST_BUCKETS; ++b)
+            if (mm.corridorHist[b])
+                printf("  length %7d-%-7d %d\n", 1 << b, (2 << b) - 1, mm.corridorHist[b]);
+        printf("reachable %d, loops %lld, start eccentricity %d, start-end distance %d\n",
+               mm.reachable, mm.loops, mm.startEccentricity, mm.endDistance);
+        printf("regions %d, start region %d cells\n", componentCount(), componentSize(startCell));
+        const DeadEndFill &fill = currentDeadEndFill();
+        printf("dead-end fill: %d of %d open cells viable (%.2f%%), %d tile rounds, %.3f ms\n", fill.viableCells,
+               fill.openCells, 100.0 * fill.viableCells / std::max(1, fill.openCells), fill.rounds, fill.seconds * 1000.0);
+    }
+
+    if (queries)
+    {
+        const TreeIndexInfo &ti = currentTreeIndex();
+        printf("tree index: %d cells, %d loop edges, %d landmarks, %s, %d table rows, %.1f MB, built in %.3f ms\n",
+               ti.cells, ti.loopEdges, ti.landmarks, ti.exact ? "exact" : "tree bounds", ti.levels,
+               ti.bytes / 1048576.0, ti.seconds * 1000.0);
+        // Pairs drawn up front so the timed loop is only the lookups
+        std::vector<int> open;
+        for (int u = 0; u < gCols * gRows; ++u)
+            if (treeLca(u, u) >= 0)
+                open.push_back(u);
+        std::vector<std::pair<int, int>> pairs(std::min<long long>(queries, 1 << 22));
+        std::uniform_int_distribution<size_t> pick(0, open.empty() ? 0 : open.size() - 1);
+        for (auto &p : pairs)
+            p = open.empty() ? std::make_pair(-1, -1) : std::make_pair(open[pick(rng)], open[pick(rng)]);
+        long long sum = 0;
+        double q0 = nowSeconds();
+        for (long long q = 0; q < queries; ++q)
+        {
+            const auto &p = pairs[q % pairs.size()];
+            sum += treeDistance(p.first, p.second);
+        }
+        double q1 = nowSeconds();
+        printf("%lld queries in %.3f ms, %.1f ns/query, mean distance %.1f\n", queries, (q1 - q0) * 1000.0,
+               (q1 - q0) * 1e9 / queries, (double)sum / queries);
+
+        // Whole BFS fields from a few sources against the index, paths included
+        int sources = std::min<int>(8, (int)open.size()), wrong = 0, looser = 0, badPaths = 0;
+        BfsField field;
+        std::vector<int> path;
+        for (int s = 0; s < sources; ++s)
+        {
+            int a = open[pick(rng)];
+            bfsFieldSequential(a, field);
+            for (int b : open)
+            {
+                int d = treeDistance(a, b);
+                if (d < field.dist[b] || (ti.exact && d != field.dist[b]))
+                    wrong++;
+                looser += d > field.dist[b];
+                if (b % 97 == 0 && (!treePath(a, b, path) || (int)path.size() != d + 1))
+                    badPaths++;
+            }
+        }
+        printf("checked %d sources against BFS: %d wrong, %d above the shortest, %d bad paths\n", sources, wrong,
+               looser, badPaths);
+    }
+
+    if (chQueries)
+    {
+        const ChInfo &ch = currentContraction();
+        printf("contraction hierarchy: %d cells, %zu shortcuts, %zu upward arcs, %.1f MB, %s in %.3f s\n", ch.cells,
+               ch.shortcuts, ch.upArcs, ch.bytes / 1048576.0, ch.loaded ? "loaded" : "built", ch.seconds);
+        std::vector<int> open;
+        for (int u = 0; u < gCols * gRows; ++u)
+            if (!grid[u].blocked)
+                open.push_back(u);
+        std::vector<std::pair<int, int>> pairs(std::min<long long>(chQueries, 1 << 22));
+        std::uniform_int_distribution<size_t> pick(0, open.empty() ? 0 : open.size() - 1);
+        for (auto &p : pairs)
+            p = open.empty() ? std::make_pair(-1, -1) : std::make_pair(open[pick(rng)], open[pick(rng)]);
+        double sum = 0.0;
+        long long connected = 0;
+        double q0 = nowSeconds();
+        for (long long q = 0; q < chQueries; ++q)
+        {
+            const auto &p = pairs[q % pairs.size()];
+            float d = chDistance(p.first, p.second);
+            if (d < std::numeric_limits<float>::infinity())
+            {
+                sum += d;
+                connected++;
+            }
+        }
+        double q1 = nowSeconds();
+        printf("%lld queries in %.3f ms, %.2f us/query, %lld connected, mean cost %.1f\n", chQueries,
+               (q1 - q0) * 1000.0, (q1 - q0) * 1e6 / chQueries, connected, sum / std::max(1LL, connected));
+
+        // A few pairs against Dijkstra: cost, and the unpacked path step by step
+        static const int dirs[4][3] = {{0, -1, 0}, {1, 0, 1}, {0, 1, 2}, {-1, 0, 3}};
+        auto stepCost = [&](int p, int q)
+        {
+            for (auto &d : dirs)
+                if (index(p % gCols + d[0], p / gCols + d[1]) == q && !grid[p].walls[d[2]] && !grid[q].blocked)
+                    return grid[q].cost;
+            return std::numeric_limits<float>::infinity();
+        };
+        auto savedEvents = std::move(events);
+        auto savedPath = std::move(finalPathEdges);
+        int savedStart = startCell, savedEnd = endCell, checks = std::min<int>(16, (int)pairs.size()), wrong = 0,
+            badPaths = 0;
+        std::vector<int> path;
+        for (int k = 0; k < checks && !open.empty(); ++k)
+        {
+            startCell = pairs[k].first;
+            endCell = pairs[k].second;
+            events.clear();
+            runSolver(2);
+            float dijkstra = startCell == endCell || !finalPathEdges.empty() ? 0.0f
+                                                                            : std::numeric_limits<float>::infinity();
+            for (auto &e : finalPathEdges)
+                dijkstra += grid[e.second].cost;
+            float d = chDistance(startCell, endCell), walked = 0.0f;
+            wrong += !(fabsf(d - dijkstra) <= 1e-3f * std::max(1.0f, dijkstra)) && d != dijkstra;
+            if (chPath(startCell, endCell, path))
+            {
+                for (size_t i = 1; i < path.size(); ++i)
+                    walked += stepCost(path[i - 1], path[i]);
+                badPaths += path.front() != startCell || path.back() != endCell ||
+                            !(fabsf(walked - d) <= 1e-3f * std::max(1.0f, d));
+            }
+            else
+                badPaths += d < std::numeric_limits<float>::infinity();
+        }
+        events = std::move(savedEvents);
+        finalPathEdges = std::move(savedPath);
+        startCell = savedStart;
+        endCell = savedEnd;
+        printf("checked %d pairs against Dijkstra: %d wrong costs, %d bad paths\n", checks, wrong, badPaths);
+    }
+
+    if (flowQueries)
+    {
+        const FlowInfo &flow = currentFlowField();
+        printf("flow field to (%d,%d): %d cells reach it, %.1f MB, built in %.3f s\n", endCell % gCols,
+               endCell / gCols, flow.reached, flow.bytes / 1048576.0, flow.seconds);
+        std::vector<int> open;
+        for (int u = 0; u < gCols * gRows; ++u)
+            if (!grid[u].blocked)
+                open.push_back(u);
+        std::vector<int> starts(std::min<long long>(flowQueries, 1 << 22), -1);
+        std::uniform_int_distribution<size_t> pick(0, open.empty() ? 0 : open.size() - 1);
+        for (int &s : starts)
+            s = open.empty() ? -1 : open[pick(rng)];
+        std::vector<int> path;
+        long long routed = 0, steps = 0;
+        double q0 = nowSeconds();
+        for (long long q = 0; q < flowQueries; ++q)
+            if (flowPath(starts[q % starts.size()], path))
+            {
+                routed++;
+                steps += (long long)path.size() - 1;
+            }
+        double q1 = nowSeconds();
+        printf("%lld paths in %.3f ms, %.2f us/path, %lld routed, mean length %.1f steps\n", flowQueries,
+               (q1 - q0) * 1000.0, (q1 - q0) * 1e6 / flowQueries, routed, (double)steps / std::max(1LL, routed));
+
+        // A few starts against Dijkstra: the cost, and that the path walks it
+        auto savedEvents = std::move(events);
+        auto savedPath = std::move(finalPathEdges);
+        int savedStart = startCell, checks = std::min<int>(16, (int)starts.size()), wrong = 0, badPaths = 0;
+        for (int k = 0; k < checks && !open.empty(); ++k)
+        {
+            startCell = starts[k];
+            events.clear();
+            runSolver(2);
+            float dijkstra = startCell == endCell || !finalPathEdges.empty() ? 0.0f
+                                                                            : std::numeric_limits<float>::infinity();
+            for (auto &e : finalPathEdges)
+                dijkstra += grid[e.second].cost;
+            float d = flowDistance(startCell), walked = 0.0f;
+            wrong += !(fabsf(d - dijkstra) <= 1e-3f * std::max(1.0f, dijkstra)) && d != dijkstra;
+            if (flowPath(startCell, path))
+            {
+                for (size_t i = 1; i < path.size(); ++i)
+                    walked += grid[path[i]].cost;
+                badPaths += path.front() != startCell || path.back() != endCell ||
+                            !(fabsf(walked - d) <= 1e-3f * std::max(1.0f, d));
+            }
+            else
+                badPaths += d < std::numeric_limits<float>::infinity();
+        }
+        events = std::move(savedEvents);
+        finalPathEdges = std::move(savedPath);
+        startCell = savedStart;
+        printf("checked %d starts against Dijkstra: %d wrong costs, %d bad paths\n", checks, wrong, badPaths);
+    }
+
+    if (savePath && !saveMaze(savePath))
+        return 1;
+
+    if (benchRuns)
+    {
+        perf = perf && perfOpen() > 0;
+        PerfSample genPerf[3], solvePerf[SOLVER_COUNT];
+        double cells = (double)gCols * gRows, expanded[SOLVER_COUNT] = {};
+
+        // Generators overwrite the grid, so the requested maze is restored afterwards
+        auto savedGrid = grid;
+        int savedGen = genAlgo, savedStart = startCell, savedEnd = endCell;
+        // Search-space shrink from dead-end filling: viable cells, and BFS expansions without/with it
+        printf("%-12s %10s %10s %9s %9s %9s %10s %10s\n", "generator", "median ms", "ns/cell", "viable %",
+               "fill ms", "tiled ms", "BFS exp", "pruned");
+        bool savedPrune = pruneDeadEnds;
+        for (int g = 0; g < 3; ++g)
+        {
+            genAlgo = g;
+            std::vector<double> times;
+            for (int r = 0; r < benchRuns; ++r)
+            {
+                double s0 = nowSeconds();
+                if (perf)
+                    perfStart();
+                regenerateMaze();
+                if (perf)
+                    genPerf[g].add(perfStop());
+                times.push_back(nowSeconds() - s0);
+            }
+            std::sort(times.begin(), times.end());
+            double median = times[times.size() / 2];
+            DeadEndFill seqFill, tiledFill;
+            componentCount(); // region labels up front, so neither fill pays for them
+            fillDeadEnds(seqFill);
+            fillDeadEndsTiled(tiledFill);
+            size_t exp[2];
+            for (int p = 0; p < 2; ++p)
+            {
+                pruneDeadEnds = p == 1;
+                resetAnimationBuffers();
+                exp[p] = runSolver(1).nodesExpanded;
+            }
+            printf("%-12s %10.3f %10.1f %8.2f%% %9.3f %9.3f %10zu %10zu%s\n", genNames[g], median * 1000.0,
+                   median * 1e9 / cells, 100.0 * seqFill.viableCells / std::max(1, seqFill.openCells),
+                   seqFill.seconds * 1000.0, tiledFill.seconds * 1000.0, exp[0], exp[1],
+                   seqFill.sealed == tiledFill.sealed ? "" : "   MISMATCH");
+        }
+        pruneDeadEnds = savedPrune;
+        resetAnimationBuffers();
+        grid = savedGrid;
+        genAlgo = savedGen;
+        startCell = savedStart;
+        endCell = savedEnd;
+        mazeRevision++;
+
+        // Median wall time over the runs; the counters are deterministic per maze
+        printf("\n%-12s %10s %10s %10s %10s %10s %8s %10s\n",
+               "solver", "median ms", "expanded", "relaxed", "peak open", "stale", "path", "scratch KB");
+        for (int a = 0; a < SOLVER_COUNT; ++a)
+        {
+            std::vector<double> times;
+            SolveStats st;
+            for (int r = 0; r < benchRuns; ++r)
+            {
+                resetAnimationBuffers();
+                if (a == 7)
+                    resetLpa(); // full plans here; repairs are timed below
+                if (perf)
+                    perfStart();
+                st = runSolver(a);
+                if (perf)
+                    solvePerf[a].add(perfStop());
+                times.push_back(st.seconds);
+            }
+            expanded[a] = (double)st.nodesExpanded;
+            std::sort(times.begin(), times.end());
+            printf("%-12s %10.3f %10zu %10zu %10zu %10zu %8zu %10.1f\n", solverNames[a],
+                   times[times.size() / 2] * 1000.0, st.nodesExpanded, st.edgesRelaxed,
+                   st.peakFrontier, st.stalePops, st.pathLength, st.scratchBytes / 1024.0);
+        }
+        resetAnimationBuffers();
+        if (solve)
+            runSolver(solveAlgo); // restore the requested solve for any image output
+
+        // Whole-grid distance field from start: queue BFS against the parallel one
+        BfsField seqField, parField;
+        std::vector<double> seqTimes, parTimes;
+        for (int r = 0; r < benchRuns; ++r)
+        {
+            bfsFieldSequential(startCell, seqField);
+            bfsFieldParallel(startCell, parField);
+            seqTimes.push_back(seqField.seconds);
+            parTimes.push_back(parField.seconds);
+        }
+        std::sort(seqTimes.begin(), seqTimes.end());
+        std::sort(parTimes.begin(), parTimes.end());
+        bool same = seqField.dist == parField.dist && seqField.parent == parField.parent;
+        printf("\n%-12s %10s %10s %10s %10s\n", "BFS field", "median ms", "reached", "levels", "bottom-up");
+        printf("%-12s %10.3f %10zu %10d %10s\n", "sequential", seqTimes[seqTimes.size() / 2] * 1000.0,
+               seqField.reached, seqField.levels, "-");
+        printf("%-12s %10.3f %10zu %10d %10d   %s\n", "parallel", parTimes[parTimes.size() / 2] * 1000.0,
+               parField.reached, parField.levels, parField.bottomUpLevels, same ? "identical" : "MISMATCH");
+
+        // Start-end distance and connectivity only, on the bitset copy of the grid
+        BitFloodResult layers, reach;
+        std::vector<double> layerTimes, reachTimes;
+        double maskSeconds = 0.0;
+        for (int r = 0; r < benchRuns; ++r)
+        {
+            layers = bitFloodDistance(startCell, endCell);
+            reach = bitFloodReach(startCell, endCell);
+            maskSeconds = std::max(maskSeconds, layers.buildSeconds);
+            layerTimes.push_back(layers.seconds);
+            reachTimes.push_back(reach.seconds);
+        }
+        std::sort(layerTimes.begin(), layerTimes.end());
+        std::sort(reachTimes.begin(), reachTimes.end());
+        int bfsDistance = endCell >= 0 && endCell < (int)seqField.dist.size() ? seqField.dist[endCell] : -1;
+        printf("\n%-12s %10s %10s %10s   (masks %.3f ms)\n", "bit flood", "median ms", "distance", "sweeps",
+               maskSeconds * 1000.0);
+        printf("%-12s %10.3f %10d %10d   %s\n", "layers", layerTimes[layerTimes.size() / 2] * 1000.0,
+               layers.distance, layers.sweeps, layers.distance == bfsDistance ? "matches BFS" : "MISMATCH");
+        printf("%-12s %10.3f %10s %10d   %s\n", "reach", reachTimes[reachTimes.size() / 2] * 1000.0,
+               reach.found ? "connected" : "cut", reach.sweeps, reach.found == (bfsDistance >= 0) ? "matches BFS" : "MISMATCH");
+
+        // HPA* abstraction: a full build, then single obstacle toggles patched cluster by cluster
+        mazeRevision++;
+        HpaInfo full = currentHpa();
+        std::vector<int> openCells;
+        for (int u = 0; u < gCols * gRows; ++u)
+            if (!grid[u].blocked && u != startCell && u != endCell)
+                openCells.push_back(u);
+        std::shuffle(openCells.begin(), openCells.end(), rng);
+        int toggles = std::min<int>(64, (int)openCells.size());
+        double updateSeconds = 0.0;
+        long long rebuilt = 0;
+        for (int t = 0; t < toggles; ++t)
+            for (bool blocked : {true, false})
+            {
+                setCellBlocked(openCells[t], blocked);
+                const HpaInfo &hi = currentHpa();
+                updateSeconds += hi.seconds;
+                rebuilt += hi.rebuilt;
+            }
+        printf("\n%-12s %10s %10s %10s %10s %12s %10s\n", "HPA*", "clusters", "nodes", "edges", "build ms",
+               "edit ms", "KB");
+        printf("%-12s %10d %10d %10zu %10.3f %12.4f %10.1f   (%d toggles, %.1f clusters each)\n", "abstraction",
+               full.clusters, full.nodes, full.intraEdges, full.seconds * 1000.0,
+               updateSeconds * 1000.0 / std::max(1, 2 * toggles), full.bytes / 1024.0, toggles,
+               (double)rebuilt / std::max(1, 2 * toggles));
+
+        // LPA*: obstacles toggled on cells of the planned path, each repair against a fresh A*
+        auto pathCost = [&]()
+        {
+            float c = 0.0f;
+            for (auto &e : finalPathEdges)
+                c += grid[e.second].cost;
+            return c;
+        };
+        resetAnimationBuffers();
+        resetLpa();
+        SolveStats plan = runSolver(7);
+        std::vector<int> pathCells;
+        for (auto &e : finalPathEdges)
+            if (e.second != endCell)
+                pathCells.push_back(e.second);
+        std::shuffle(pathCells.begin(), pathCells.end(), rng);
+        int edits = std::min<int>(32, (int)pathCells.size()), mismatches = 0;
+        double repairSeconds = 0.0, astarSeconds = 0.0;
+        size_t repairExpanded = 0, astarExpanded = 0;
+        for (int t = 0; t < edits; ++t)
+            for (bool blocked : {true, false})
+            {
+                setCellBlocked(pathCells[t], blocked);
+                resetAnimationBuffers();
+                SolveStats r = runSolver(7);
+                float repaired = pathCost();
+                resetAnimationBuffers();
+                SolveStats a = runSolver(3);
+                mismatches += repaired != pathCost();
+                repairSeconds += r.seconds;
+                repairExpanded += r.nodesExpanded;
+                astarSeconds += a.seconds;
+                astarExpanded += a.nodesExpanded;
+            }
+        int solves = std::max(1, 2 * edits);
+        printf("\n%-12s %10s %10s %12s %10s %10s\n", "LPA*", "plan ms", "repair ms", "repair exp", "A* ms", "A* exp");
+        printf("%-12s %10.3f %10.3f %12.1f %10.3f %10.1f   (%d path toggles, %s)\n", "path edits",
+               plan.seconds * 1000.0, repairSeconds * 1000.0 / solves, (double)repairExpanded / solves,
+               astarSeconds * 1000.0 / solves, (double)astarExpanded / solves, edits,
+               mismatches ? "COST MISMATCH" : "same costs as A*");
+        resetAnimationBuffers();
+        if (solve)
+            runSolver(solveAlgo);
+
+        if (perf)
+        {
+            printf("\n");
+            printPerfHeader("generator", "cell");
+            for (int g = 0; g < 3; ++g)
+                printPerfRow(genNames[g], genPerf[g], cells);
+            printPerfHeader("solver", "node");
+            for (int a = 0; a < SOLVER_COUNT; ++a)
+                printPerfRow(solverNames[a], solvePerf[a], expanded[a]);
+            perfClose();
+        }
+    }
+
+    OverlayState overlay;
+    SoftwareImage img;
+    if (pngPath)
+    {
+        overlay.reset();
+        overlay.advanceTo(at < 0 ? events.size() : (size_t)at);
+        overlay.showPath(showPath && overlay.applied == events.size());
+        double r0 = nowSeconds();
+        renderMazeFrame(img, width, overlay);
+        double r1 = nowSeconds();
+        if (!writePng(pngPath, img.w, img.h, img.px, renderPalette, RC_COUNT))
+            return 1;
+        logf("%s: %dx%d rendered in %.3fs, encoded in %.3fs", pngPath, img.w, img.h, r1 - r0, nowSeconds() - r1);
+    }
+    if (gifPath)
+    {
+        if (every <= 0)
+            every = std::max<long long>(1, (long long)events.size() / 100);
+        overlay.reset();
+        GifWriter gif;
+        double r0 = nowSeconds(), renderTime = 0;
+        int frames = 0;
+        for (size_t n = 0;; n += (size_t)every)
+        {
+            bool last = n >= events.size();
+            overlay.advanceTo(n);
+            overlay.showPath(last && showPath);
+            double f0 = nowSeconds();
+            renderMazeFrame(img, width, overlay);
+            renderTime += nowSeconds() - f0;
+            if (!frames && !gif.open(gifPath, img.w, img.h, renderPalette, RC_COUNT))
+                return 1;
+            gif.addFrame(img.px, last ? delay * 50 : delay); // linger on the result
+            frames++;
+            if (last)
+                break;
+        }
+        if (!gif.close())
+            return 1;
+        logf("%s: %d frames of %dx%d, rendering %.3fs, total %.3fs",
+             gifPath, frames, img.w, img.h, renderTime, nowSeconds() - r0);
+    }
+    if (tracePath && !writeTrace(tracePath))
+        return 1;
+    return 0;
+}
@@ -0,0 +1,291 @@
+#include "../headers/bit_flood.h"
+#include "../headers/parallel.h"
+#include "../headers/tracing.h"
+#include <chrono>
+
+// Move masks, row-major with `words` words per row; bits past gCols stay 0 so
+// nothing moves into the padding. east: x -> x+1, leftIn: x is entered from x+1
+// (the shape the leftward fill wants), down: y -> y+1, up: y -> y-1.
+static std::vector<uint64_t> east, leftIn, down, up;
+static int words = 0, maskCols = -1, maskRows = -1;
+static unsigned int maskRevision = 0;
+
+// Query scratch, same shape as the masks
+static std::vector<uint64_t> fill, frontier, next;
+static std::vector<int> active, touched;
+
+static double nowSeconds()
+{
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+static void buildRows(int y0, int y1)
+{
+    const int C = gCols;
+    for (int y = y0; y < y1; ++y)
+    {
+        const Cell *row = &grid[(size_t)y * C];
+        size_t base = (size_t)y * words;
+        for (int w = 0; w < words; ++w)
+        {
+            uint64_t e = 0, l = 0, d = 0, u = 0;
+            for (int b = 0, x = w * 64; b < 64 && x < C; ++b, ++x)
+            {
+                const Cell &c = row[x];
+                if (c.blocked)
+                    continue;
+                uint64_t bit = uint64_t(1) << b;
+                if (x + 1 < C && !c.walls[1] && !row[x + 1].blocked)
+                    e |= bit;
+                if (x + 1 < C && !row[x + 1].walls[3] && !row[x + 1].blocked)
+                    l |= bit;
+                if (y + 1 < gRows && !c.walls[2] && !row[x + C].blocked)
+                    d |= bit;
+                if (y > 0 && !c.walls[0] && !row[x - C].blocked)
+                    u |= bit;
+            }
+            east[base + w] = e;
+            leftIn[base + w] = l;
+            down[base + w] = d;
+            up[base + w] = u;
+        }
+    }
+}
+
+// Returns the rebuild time, 0 when the masks already match the grid
+static double ensureMasks()
+{
+    if (maskRevision == mazeRevision && maskCols == gCols && maskRows == gRows)
+        return 0.0;
+    TraceScope trace("bitFlood masks");
+    double t0 = nowSeconds();
+    words = (gCols + 63) / 64;
+    size_t n = (size_t)words * gRows;
+    for (auto *v : {&east, &leftIn, &down, &up, &fill, &frontier, &next})
+        v->assign(n, 0);
+    int bands = std::max(1, std::min(gRows, workerCount() * 4));
+    parallelFor(bands, [&](int i)
+                { buildRows(gRows * i / bands, gRows * (i + 1) / bands); });
+    maskRevision = mazeRevision;
+    maskCols = gCols;
+    maskRows = gRows;
+    return nowSeconds() - t0;
+}
+
+static bool validCell(int c)
+{
+    return c >= 0 && c < gCols * gRows && !grid[c].blocked;
+}
+
+static size_t countBits(const std::vector<uint64_t> &v)
+{
+    size_t n = 0;
+    for (uint64_t w : v)
+        n += __builtin_popcountll(w);
+    return n;
+}
+
+// Layer-synchronous: each frontier word pushes its moves into the next layer's
+// words (itself and its four neighbours), so a layer costs its frontier's words
+// rather than the grid
+BitFloodResult bitFloodDistance(int source, int target)
+{
+    TraceScope trace("bitFloodDistance");
+    BitFloodResult res;
+    res.buildSeconds = ensureMasks();
+    double t0 = nowSeconds();
+    if (!validCell(source) || target < 0 || target >= gCols * gRows)
+        return res;
+    const int W = words;
+    const int total = W * gRows;
+    auto wordOf = [&](int c)
+    { return (size_t)(c / gCols) * W + c % gCols / 64; };
+    size_t targetWord = wordOf(target);
+    uint64_t targetBit = uint64_t(1) << (target % gCols % 64);
+
+    std::fill(fill.begin(), fill.end(), 0);
+    active.assign(1, (int)wordOf(source));
+    frontier[active[0]] = fill[active[0]] = uint64_t(1) << (source % gCols % 64);
+    res.reached = 1;
+    for (int layer = 0; !active.empty(); ++layer)
+    {
+        if (fill[targetWord] & targetBit)
+        {
+            res.found = true;
+            res.distance = layer;
+            break;
+        }
+        touched.clear();
+        auto push = [&](size_t j, uint64_t bits)
+        {
+            if (!bits)
+                return;
+            if (!next[j])
+                touched.push_back((int)j);
+            next[j] |= bits;
+        };
+        for (int i : active)
+        {
+            uint64_t f = frontier[i], r = f & east[i];
+            frontier[i] = 0;
+            int w = i % W;
+            // Right and left steps, with the bit that crosses into the next word
+            push(i, r << 1 | ((f >> 1) & leftIn[i]));
+            if (w + 1 < W)
+                push(i + 1, r >> 63);
+            if (w > 0)
+                push(i - 1, (f << 63) & leftIn[i - 1]);
+            if (i + W < total)
+                push(i + W, f & down[i]);
+            if (i >= W)
+                push(i - W, f & up[i]);
+        }
+        active.clear();
+        for (int j : touched)
+        {
+            uint64_t n = next[j] & ~fill[j];
+            next[j] = 0;
+            if (!n)
+                continue;
+            frontier[j] = n;
+            fill[j] |= n;
+            res.reached += __builtin_popcountll(n);
+            active.push_back(j);
+        }
+        res.sweeps = layer + 1;
+    }
+    for (int i : active)
+        frontier[i] = 0;
+    res.seconds = nowSeconds() - t0;
+    return res;
+}
+
+// Saturates one row: seeds spread right along `east` by carrying through runs of
+// set bits in an add, then left along `leftIn` by doubling shifts, both chained
+// across the row's words. Right then left reaches the row's fixpoint.
+static bool fillRow(int y, const uint64_t *seed)
+{
+    const int W = words;
+    size_t base = (size_t)y * W;
+    uint64_t *row = &fill[base];
+    uint64_t *tmp = &next[base];
+    uint64_t carry = 0;
+    for (int w = 0; w < W; ++w)
+    {
+        uint64_t m = east[base + w], s = seed[w];
+        uint64_t sum = m + (s & m), c1 = sum < m;
+        uint64_t sum2 = sum + carry, c2 = sum2 < sum;
+        tmp[w] = (sum2 ^ m) | s;
+        carry = c1 | c2;
+    }
+    bool changed = false;
+    uint64_t in = 0; // bit 0 of the filled word to the right
+    for (int w = W - 1; w >= 0; --w)
+    {
+        uint64_t p = leftIn[base + w];
+        uint64_t g = tmp[w] | ((in & (p >> 63)) << 63);
+        g |= p & (g >> 1);
+        p &= p >> 1;
+        g |= p & (g >> 2);
+        p &= p >> 2;
+        g |= p & (g >> 4);
+        p &= p >> 4;
+        g |= p & (g >> 8);
+        p &= p >> 8;
+        g |= p & (g >> 16);
+        p &= p >> 16;
+        g |= p & (g >> 32);
+        tmp[w] = 0;
+        changed |= g != row[w];
+        row[w] = g;
+        in = g & 1;
+    }
+    return changed;
+}
+
+// Rows are refilled only when a neighbouring row gained cells, in alternating
+// downward and upward passes over the pending range, until nothing changes
+BitFloodResult bitFloodReach(int source, int target)
+{
+    TraceScope trace("bitFloodReach");
+    BitFloodResult res;
+    res.buildSeconds = ensureMasks();
+    double t0 = nowSeconds();
+    if (!validCell(source))
+        return res;
+    const int W = words, R = gRows;
+    std::fill(fill.begin(), fill.end(), 0);
+    std::vector<uint64_t> seed(W);
+    std::vector<char> pending(R, 0);
+    int sy = source / gCols;
+    fill[(size_t)sy * W + source % gCols / 64] = uint64_t(1) << (source % gCols % 64);
+    int lo = R, hi = -1; // pending rows lie in [lo, hi]
+    size_t targetWord = 0;
+    uint64_t targetBit = 0;
+    if (target >= 0 && target < gCols * R)
+    {
+        targetWord = (size_t)(target / gCols) * W + target % gCols / 64;
+        targetBit = uint64_t(1) << (target % gCols % 64);
+    }
+
+    auto mark = [&](int y)
+    {
+        if (y < 0 || y >= R || pending[y])
+            return;
+        pending[y] = 1;
+        lo = std::min(lo, y);
+        hi = std::max(hi, y);
+    };
+    auto refill = [&](int y)
+    {
+        pending[y] = 0;
+        const uint64_t *row = &fill[(size_t)y * W];
+        for (int w = 0; w < W; ++w)
+            seed[w] = row[w];
+        if (y > 0)
+            for (int w = 0; w < W; ++w)
+                seed[w] |= row[w - W] & down[(size_t)(y - 1) * W + w];
+        if (y + 1 < R)
+            for (int w = 0; w < W; ++w)
+                seed[w] |= row[w + W] & up[(size_t)(y + 1) * W + w];
+        if (fillRow(y, seed.data()))
+        {
+            mark(y - 1);
+            mark(y + 1);
+        }
+    };
+    // The source row starts unsaturated, so its first fill counts as a change
+    fillRow(sy, &fill[(size_t)sy * W]);
+    mark(sy - 1);
+    mark(sy + 1);
+    while (lo <= hi && !(targetBit && (fill[targetWord] & targetBit)))
+    {
+        bool downward = res.sweeps % 2 == 0;
+        int from = lo, to = hi;
+        lo = R;
+        hi = -1;
+        if (downward)
+        {
+            for (int y = from; y <= std::max(to, hi); ++y)
+                if (pending[y])
+                    refill(y);
+        }
+        else
+        {
+            for (int y = to; y >= std::min(from, lo); --y)
+                if (pending[y])
+                    refill(y);
+        }
+        res.sweeps++;
+    }
+    res.found = targetBit && (fill[targetWord] & targetBit);
+    res.reached = countBits(fill);
+    res.seconds = nowSeconds() - t0;
+    return res;
+}
+
+bool bitFloodConnected(int source, int target)
+{
+    return validCell(target) && bitFloodReach(source, target).found;
+}
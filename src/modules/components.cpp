@@ -0,0 +1,319 @@
+#include "../headers/components.h"
+#include "../headers/parallel.h"
+#include "../headers/tracing.h"
+
+// Region id per cell (-1 blocked). A rebuild uses each region's first cell as
+// its id; regions split off later get fresh ids past the grid.
+static std::vector<int> label, scratch;
+static std::vector<int> regionSize; // cells per id, 0 once an id is merged away
+static int regions = 0;
+static unsigned int labelRevision = ~0u;
+static int labelCols = -1, labelRows = -1;
+
+// Split searches: which search first reached a cell, valid when seenStamp == epoch
+static std::vector<int> seenStamp, seenBy;
+static int epoch = 0;
+
+static bool labelsCurrent()
+{
+    return labelRevision == mazeRevision && labelCols == gCols && labelRows == gRows;
+}
+
+static void ensureLabels()
+{
+    if (!labelsCurrent())
+        buildComponents();
+}
+
+int openNeighbours(int u, int out[4])
+{
+    const int C = gCols, N = gCols * gRows;
+    int x = u % C, n = 0;
+    if (u >= C && openBetween(u, u - C) && !grid[u - C].blocked)
+        out[n++] = u - C;
+    if (x + 1 < C && openBetween(u, u + 1) && !grid[u + 1].blocked)
+        out[n++] = u + 1;
+    if (u + C < N && openBetween(u, u + C) && !grid[u + C].blocked)
+        out[n++] = u + C;
+    if (x > 0 && openBetween(u, u - 1) && !grid[u - 1].blocked)
+        out[n++] = u - 1;
+    return n;
+}
+
+// During a rebuild `label` holds union-find parents
+static int findRoot(int x)
+{
+    while (label[x] != x)
+    {
+        label[x] = label[label[x]]; // path halving
+        x = label[x];
+    }
+    return x;
+}
+
+// The larger root goes under the smaller, so a root is its region's first cell
+static void unite(int a, int b)
+{
+    a = findRoot(a);
+    b = findRoot(b);
+    if (a < b)
+        label[b] = a;
+    else if (b < a)
+        label[a] = b;
+}
+
+// Bands only link cells inside their own rows, so they never touch each other's parents
+static void uniteBand(int y0, int y1)
+{
+    const int C = gCols;
+    for (int u = y0 * C; u < y1 * C; ++u)
+    {
+        if (grid[u].blocked)
+        {
+            label[u] = -1;
+            continue;
+        }
+        label[u] = u;
+        if (u % C > 0 && label[u - 1] >= 0 && openBetween(u, u - 1))
+            unite(u, u - 1);
+        if (u >= (y0 + 1) * C && label[u - C] >= 0 && openBetween(u, u - C))
+            unite(u, u - C);
+    }
+}
+
+void buildComponents()
+{
+    TraceScope trace("buildComponents");
+    const int C = gCols, N = gCols * gRows;
+    label.resize(N);
+    scratch.resize(N);
+    int bands = std::max(1, std::min(gRows, workerCount() * 4));
+    parallelFor(bands, [&](int i)
+                { uniteBand(gRows * i / bands, gRows * (i + 1) / bands); });
+    for (int i = 1; i < bands; ++i)
+    {
+        int y = gRows * i / bands;
+        for (int u = y * C; u < (y + 1) * C; ++u)
+            if (label[u] >= 0 && label[u - C] >= 0 && openBetween(u, u - C))
+                unite(u, u - C);
+    }
+    // Flatten without compressing, since other bands may be walking the same chains
+    parallelFor(bands, [&](int i)
+                {
+        for (int u = (int)((long long)N * i / bands); u < (int)((long long)N * (i + 1) / bands); ++u)
+        {
+            int r = label[u];
+            if (r >= 0)
+                while (label[r] != r)
+                    r = label[r];
+            scratch[u] = r;
+        } });
+    label.swap(scratch);
+
+    regionSize.assign(N, 0);
+    regions = 0;
+    for (int u = 0; u < N; ++u)
+        if (label[u] >= 0)
+        {
+            regionSize[label[u]]++;
+            regions += label[u] == u;
+        }
+    seenStamp.assign(N, 0);
+    seenBy.assign(N, 0);
+    epoch = 0;
+    labelRevision = mazeRevision;
+    labelCols = gCols;
+    labelRows = gRows;
+}
+
+static int newRegion()
+{
+    regionSize.push_back(0);
+    regions++;
+    return (int)regionSize.size() - 1;
+}
+
+// Moves every cell of region `from` reachable from `seed` into region `to`
+static void relabel(int seed, int from, int to)
+{
+    std::vector<int> stack{seed};
+    label[seed] = to;
+    while (!stack.empty())
+    {
+        int u = stack.back(), nb[4];
+        stack.pop_back();
+        for (int i = 0, k = openNeighbours(u, nb); i < k; ++i)
+            if (label[nb[i]] == from)
+            {
+                label[nb[i]] = to;
+                stack.push_back(nb[i]);
+            }
+    }
+    regionSize[to] += regionSize[from];
+    regionSize[from] = 0;
+    regions--;
+}
+
+static void cellUnblocked(int c)
+{
+    int nb[4], k = openNeighbours(c, nb), keep = -1;
+    for (int i = 0; i < k; ++i)
+        if (keep < 0 || regionSize[label[nb[i]]] > regionSize[keep])
+            keep = label[nb[i]];
+    if (keep < 0)
+        keep = newRegion();
+    label[c] = keep;
+    regionSize[keep]++;
+    for (int i = 0; i < k; ++i)
+        if (label[nb[i]] != keep)
+            relabel(nb[i], label[nb[i]], keep);
+}
+
+// One search per open neighbour, each taking a cell per round. Searches that
+// meet join a group; once at most one group can still grow, every exhausted
+// group is a region of its own and the growing one keeps the old id.
+static void cellBlocked(int c)
+{
+    int old = label[c], nb[4], k = openNeighbours(c, nb);
+    label[c] = -1;
+    regionSize[old]--;
+    if (k == 0)
+    {
+        regions--;
+        return;
+    }
+    if (k == 1)
+        return;
+
+    static std::vector<int> cells[4];
+    size_t head[4] = {};
+    int group[4];
+    epoch++;
+    for (int i = 0; i < k; ++i)
+    {
+        cells[i].assign(1, nb[i]);
+        group[i] = i;
+        seenStamp[nb[i]] = epoch;
+        seenBy[nb[i]] = i;
+    }
+    auto groupOf = [&](int i)
+    {
+        while (group[i] != i)
+            i = group[i];
+        return i;
+    };
+    auto growing = [&](int g)
+    {
+        for (int i = 0; i < k; ++i)
+            if (groupOf(i) == g && head[i] < cells[i].size())
+                return true;
+        return false;
+    };
+    for (;;)
+    {
+        int groups = 0, alive = 0;
+        for (int g = 0; g < k; ++g)
+            if (groupOf(g) == g)
+            {
+                groups++;
+                alive += growing(g);
+            }
+        if (groups == 1 || alive <= 1)
+            break;
+        for (int i = 0; i < k; ++i)
+        {
+            if (head[i] == cells[i].size())
+                continue;
+            int u = cells[i][head[i]++], vn[4];
+            for (int j = 0, n = openNeighbours(u, vn); j < n; ++j)
+            {
+                int v = vn[j];
+                if (seenStamp[v] != epoch)
+                {
+                    seenStamp[v] = epoch;
+                    seenBy[v] = i;
+                    cells[i].push_back(v);
+                    continue;
+                }
+                int a = groupOf(i), b = groupOf(seenBy[v]);
+                if (a != b)
+                    group[std::max(a, b)] = std::min(a, b);
+            }
+        }
+    }
+
+    // With every group exhausted, the largest keeps the old id
+    int keep = -1;
+    size_t keepCells = 0;
+    for (int g = 0; g < k; ++g)
+    {
+        if (groupOf(g) != g)
+            continue;
+        size_t n = 0;
+        for (int i = 0; i < k; ++i)
+            if (groupOf(i) == g)
+                n += cells[i].size();
+        if (growing(g) || keep < 0 || (!growing(keep) && n > keepCells))
+        {
+            keep = g;
+            keepCells = n;
+        }
+    }
+    for (int g = 0; g < k; ++g)
+    {
+        if (groupOf(g) != g || g == keep)
+            continue;
+        int id = newRegion();
+        for (int i = 0; i < k; ++i)
+            if (groupOf(i) == g)
+                for (int u : cells[i])
+                    label[u] = id;
+        for (int i = 0; i < k; ++i)
+            if (groupOf(i) == g)
+            {
+                regionSize[id] += (int)cells[i].size();
+                regionSize[old] -= (int)cells[i].size();
+            }
+    }
+}
+
+void componentsCellChanged(int cell)
+{
+    // Only an up-to-date labelling one edit behind can be patched; anything
+    // older is rebuilt on the next query
+    if (labelRevision + 1 != mazeRevision || labelCols != gCols || labelRows != gRows ||
+        cell < 0 || cell >= gCols * gRows)
+        return;
+    TraceScope trace("componentsCellChanged");
+    if (grid[cell].blocked && label[cell] >= 0)
+        cellBlocked(cell);
+    else if (!grid[cell].blocked && label[cell] < 0)
+        cellUnblocked(cell);
+    labelRevision = mazeRevision;
+}
+
+int componentOf(int cell)
+{
+    if (cell < 0 || cell >= gCols * gRows)
+        return -1;
+    ensureLabels();
+    return label[cell];
+}
+
+bool cellsConnected(int a, int b)
+{
+    int la = componentOf(a);
+    return la >= 0 && la == componentOf(b);
+}
+
+int componentCount()
+{
+    ensureLabels();
+    return regions;
+}
+
+int componentSize(int cell)
+{
+    int l = componentOf(cell);
+    return l >= 0 ? regionSize[l] : 0;
+}
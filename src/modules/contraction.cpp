@@ -0,0 +1,578 @@
+#include "../headers/contraction.h"
+#include "../headers/components.h"
+#include "../headers/logging.h"
+#include "../headers/parallel.h"
+#include "../headers/tracing.h"
+#include <chrono>
+
+static const float INF = std::numeric_limits<float>::infinity();
+// Cells a witness search settles before giving up; the shortcut is then kept
+static const int witnessLimit = 500;
+
+// to: the other cell; mid: the cell a shortcut skips, -1 for a grid step
+struct Arc
+{
+    int to;
+    float w;
+    int mid;
+};
+
+// The query side numbers cells by contraction order (blocked cells first), so
+// the top of the hierarchy, where every search ends up, is packed together
+static ChInfo info;
+static std::vector<int> cellOf, rankOf;
+static std::vector<int> upStart; // CSR over ranks: arcs to cells contracted later, in ranks
+static std::vector<Arc> upArcs;
+static unsigned int chRevision = ~0u;
+static int chCols = -1, chRows = -1;
+
+static double nowSeconds()
+{
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+static bool openCell(int c)
+{
+    return c >= 0 && c < gCols * gRows && !grid[c].blocked;
+}
+
+// ---- Preprocessing ----
+
+// Arcs between cells not contracted yet, stored at both ends
+using Graph = std::vector<std::vector<Arc>>;
+
+// Dijkstra scratch, stamped per search; one per worker while the first
+// priorities are computed
+struct Witness
+{
+    std::vector<float> dist;
+    std::vector<unsigned int> seen;
+    unsigned int epoch = 0;
+    std::vector<std::pair<float, int>> heap;
+    void init(int n)
+    {
+        dist.assign(n, INF);
+        seen.assign(n, 0);
+        epoch = 0;
+    }
+    float at(int c) const { return seen[c] == epoch ? dist[c] : INF; }
+};
+
+// From u over the remaining graph without v, up to maxCost or witnessLimit
+// settled cells. Cells left in the heap keep a real (if not shortest) cost.
+static void witnessSearch(const Graph &g, Witness &ws, int u, int v, float maxCost)
+{
+    if (++ws.epoch == 0)
+    {
+        std::fill(ws.seen.begin(), ws.seen.end(), 0);
+        ws.epoch = 1;
+    }
+    auto &heap = ws.heap;
+    heap.clear();
+    auto reach = [&](int c, float d)
+    {
+        if (ws.at(c) <= d)
+            return;
+        ws.seen[c] = ws.epoch;
+        ws.dist[c] = d;
+        heap.push_back({d, c});
+        std::push_heap(heap.begin(), heap.end(), std::greater<>());
+    };
+    reach(u, 0.0f);
+    for (int settled = 0; !heap.empty() && settled < witnessLimit;)
+    {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<>());
+        auto [d, c] = heap.back();
+        heap.pop_back();
+        if (d > ws.dist[c])
+            continue;
+        if (d > maxCost)
+            break;
+        settled++;
+        for (const Arc &a : g[c])
+            if (a.to != v)
+                reach(a.to, d + a.w);
+    }
+}
+
+// Shortcuts contracting v calls for: neighbour pairs whose path through v no
+// witness matches. Counted only when out is null.
+static int shortcutsFor(const Graph &g, Witness &ws, int v, std::vector<std::pair<int, Arc>> *out)
+{
+    const std::vector<Arc> &nb = g[v];
+    float longest = 0.0f;
+    for (const Arc &a : nb)
+        longest = std::max(longest, a.w);
+    int count = 0;
+    for (size_t i = 0; i + 1 < nb.size(); ++i)
+    {
+        witnessSearch(g, ws, nb[i].to, v, nb[i].w + longest);
+        for (size_t j = i + 1; j < nb.size(); ++j)
+        {
+            float via = nb[i].w + nb[j].w;
+            if (ws.at(nb[j].to) <= via)
+                continue;
+            count++;
+            if (out)
+                out->push_back({nb[i].to, Arc{nb[j].to, via, v}});
+        }
+    }
+    return count;
+}
+
+static int priority(const Graph &g, Witness &ws, const std::vector<int> &contractedAround, int v)
+{
+    return shortcutsFor(g, ws, v, nullptr) - (int)g[v].size() + contractedAround[v];
+}
+
+// Keeps the cheaper of parallel arcs
+static void addArc(std::vector<Arc> &arcs, const Arc &a)
+{
+    for (Arc &e : arcs)
+        if (e.to == a.to)
+        {
+            if (a.w < e.w)
+                e = a;
+            return;
+        }
+    arcs.push_back(a);
+}
+
+static void buildHierarchy()
+{
+    TraceScope trace("buildContraction");
+    double t0 = nowSeconds();
+    const int C = gCols, N = gCols * gRows;
+    info = ChInfo();
+
+    // Grid steps
+    Graph g(N);
+    for (int u = 0; u < N; ++u)
+    {
+        if (grid[u].blocked)
+            continue;
+        info.cells++;
+        auto link = [&](int v)
+        {
+            float w = 0.5f * (grid[u].cost + grid[v].cost);
+            g[u].push_back({v, w, -1});
+            g[v].push_back({u, w, -1});
+        };
+        if (u % C + 1 < C && openBetween(u, u + 1) && !grid[u + 1].blocked)
+            link(u + 1);
+        if (u + C < N && openBetween(u, u + C) && !grid[u + C].blocked)
+            link(u + C);
+    }
+
+    // First priorities in parallel: the graph is only read
+    std::vector<int> prio(N, 0), contractedAround(N, 0);
+    int parts = std::max(1, std::min(workerCount(), N / 4096));
+    parallelFor(parts, [&](int p)
+                {
+        Witness ws;
+        ws.init(N);
+        for (int v = (int)((long long)N * p / parts); v < (int)((long long)N * (p + 1) / parts); ++v)
+            if (!grid[v].blocked)
+                prio[v] = priority(g, ws, contractedAround, v); });
+
+    using P = std::pair<int, int>;
+    std::priority_queue<P, std::vector<P>, std::greater<P>> queue;
+    for (int v = 0; v < N; ++v)
+        if (!grid[v].blocked)
+            queue.push({prio[v], v});
+
+    Witness ws;
+    ws.init(N);
+    std::vector<char> contracted(N, 0);
+    Graph up(N);
+    cellOf.clear();
+    cellOf.reserve(N);
+    for (int v = 0; v < N; ++v)
+        if (grid[v].blocked)
+            cellOf.push_back(v);
+    std::vector<std::pair<int, Arc>> added;
+    while (!queue.empty())
+    {
+        auto [p, v] = queue.top();
+        queue.pop();
+        if (contracted[v] || p != prio[v])
+            continue; // superseded by a later push
+        // Lazy update: a cell whose priority grew goes back unless it still leads
+        int now = priority(g, ws, contractedAround, v);
+        if (now > p && !queue.empty() && now > queue.top().first)
+        {
+            prio[v] = now;
+            queue.push({now, v});
+            continue;
+        }
+
+        added.clear();
+        shortcutsFor(g, ws, v, &added);
+        for (const Arc &a : g[v])
+        {
+            std::vector<Arc> &back = g[a.to];
+            back.erase(std::remove_if(back.begin(), back.end(), [&](const Arc &e)
+                                      { return e.to == v; }),
+                       back.end());
+            contractedAround[a.to]++;
+        }
+        for (const auto &[x, a] : added)
+        {
+            addArc(g[x], a);
+            addArc(g[a.to], Arc{x, a.w, a.mid});
+        }
+        contracted[v] = 1;
+        cellOf.push_back(v);
+        up[v].swap(g[v]); // every remaining neighbour is contracted later
+        for (const Arc &a : up[v])
+        {
+            prio[a.to] = priority(g, ws, contractedAround, a.to);
+            queue.push({prio[a.to], a.to});
+        }
+    }
+
+    rankOf.assign(N, 0);
+    for (int r = 0; r < N; ++r)
+        rankOf[cellOf[r]] = r;
+    upStart.assign(N + 1, 0);
+    upArcs.clear();
+    for (int r = 0; r < N; ++r)
+    {
+        for (const Arc &a : up[cellOf[r]])
+            upArcs.push_back({rankOf[a.to], a.w, a.mid < 0 ? -1 : rankOf[a.mid]});
+        upStart[r + 1] = (int)upArcs.size();
+    }
+    info.upArcs = upArcs.size();
+    for (const Arc &a : upArcs)
+        info.shortcuts += a.mid >= 0;
+    info.bytes = (cellOf.size() + rankOf.size() + upStart.size()) * sizeof(int) + upArcs.size() * sizeof(Arc);
+    info.seconds = nowSeconds() - t0;
+    logf("Contraction hierarchy: %d cells, %zu shortcuts, %zu upward arcs in %.3fs", info.cells,
+         info.shortcuts, info.upArcs, info.seconds);
+}
+
+bool contractionCurrent()
+{
+    return chRevision == mazeRevision && chCols == gCols && chRows == gRows;
+}
+
+const ChInfo &currentContraction()
+{
+    if (!contractionCurrent())
+    {
+        buildHierarchy();
+        chRevision = mazeRevision;
+        chCols = gCols;
+        chRows = gRows;
+    }
+    return info;
+}
+
+// ---- Queries ----
+
+// One direction's scratch over ranks, stamped per query so a query costs only
+// what it touches; a rank's three fields share a cache line
+struct Slot
+{
+    float dist;
+    int pred;
+    unsigned int seen;
+};
+struct Side
+{
+    std::vector<Slot> slots;
+    std::vector<std::pair<float, int>> heap;
+    float at(int r, unsigned int epoch) const { return slots[r].seen == epoch ? slots[r].dist : INF; }
+};
+static Side sides[2];
+static unsigned int queryEpoch = 0;
+
+// Bidirectional Dijkstra along upward arcs only; both ends climb the same arcs
+// because the mean-cost weights are symmetric. Takes and returns ranks: the
+// meeting rank, -1 when the searches never meet.
+static int upwardSearch(int s, int t, float &best, SolveStats &stats)
+{
+    const int N = gCols * gRows;
+    for (Side &sd : sides)
+        if ((int)sd.slots.size() != N)
+        {
+            sd.slots.assign(N, Slot{INF, -1, 0});
+            queryEpoch = 0;
+        }
+    if (++queryEpoch == 0)
+    {
+        for (Side &sd : sides)
+            for (Slot &sl : sd.slots)
+                sl.seen = 0;
+        queryEpoch = 1;
+    }
+    auto reach = [&](Side &sd, int r, float d, int from)
+    {
+        if (sd.at(r, queryEpoch) <= d)
+            return;
+        sd.slots[r] = {d, from, queryEpoch};
+        sd.heap.push_back({d, r});
+        std::push_heap(sd.heap.begin(), sd.heap.end(), std::greater<>());
+        stats.edgesRelaxed++;
+    };
+    for (Side &sd : sides)
+        sd.heap.clear();
+    reach(sides[0], s, 0.0f, -1);
+    reach(sides[1], t, 0.0f, -1);
+
+    best = INF;
+    int meet = -1;
+    for (;;)
+    {
+        // Expand the side with the smaller key; done once neither can beat best
+        float k0 = sides[0].heap.empty() ? INF : sides[0].heap.front().first;
+        float k1 = sides[1].heap.empty() ? INF : sides[1].heap.front().first;
+        if (std::min(k0, k1) >= best)
+            break;
+        int i = k0 <= k1 ? 0 : 1;
+        Side &sd = sides[i];
+        const Side &other = sides[1 - i];
+        stats.peakFrontier = std::max(stats.peakFrontier, sides[0].heap.size() + sides[1].heap.size());
+        std::pop_heap(sd.heap.begin(), sd.heap.end(), std::greater<>());
+        auto [d, u] = sd.heap.back();
+        sd.heap.pop_back();
+        if (d > sd.slots[u].dist)
+        {
+            stats.stalePops++;
+            continue;
+        }
+        // Stall on demand: a higher neighbour this side already reached cheaper
+        // than d minus their arc proves d is not u's distance; u is left out
+        bool stalled = false;
+        for (int e = upStart[u]; e < upStart[u + 1] && !stalled; ++e)
+            stalled = sd.at(upArcs[e].to, queryEpoch) + upArcs[e].w < d;
+        if (stalled)
+        {
+            stats.stalePops++;
+            continue;
+        }
+        stats.nodesExpanded++;
+        float total = d + other.at(u, queryEpoch);
+        if (total < best)
+        {
+            best = total;
+            meet = u;
+        }
+        for (int e = upStart[u]; e < upStart[u + 1]; ++e)
+            reach(sd, upArcs[e].to, d + upArcs[e].w, u);
+    }
+    stats.scratchBytes = (size_t)2 * N * sizeof(Slot) +
+                         (sides[0].heap.capacity() + sides[1].heap.capacity()) * sizeof(std::pair<float, int>);
+    return meet;
+}
+
+// Skipped rank of the arc between ranks x and y, which the lower one holds;
+// -1 for a grid step (or a pair a damaged file lacks)
+static int midOf(int x, int y)
+{
+    if (x > y)
+        std::swap(x, y);
+    for (int e = upStart[x]; e < upStart[x + 1]; ++e)
+        if (upArcs[e].to == y)
+            return upArcs[e].mid;
+    return -1;
+}
+
+// Appends the cells after rank a up to rank b that their arc stands for;
+// shortcuts can nest deep, so the halves go on an explicit stack
+static void unpack(int a, int b, std::vector<int> &cells)
+{
+    struct Span
+    {
+        int from, to, mid;
+    };
+    std::vector<Span> stack{{a, b, midOf(a, b)}};
+    while (!stack.empty())
+    {
+        Span s = stack.back();
+        stack.pop_back();
+        if (s.mid < 0)
+        {
+            cells.push_back(cellOf[s.to]);
+            continue;
+        }
+        stack.push_back({s.mid, s.to, midOf(s.mid, s.to)});
+        stack.push_back({s.from, s.mid, midOf(s.from, s.mid)});
+    }
+}
+
+static bool query(int a, int b, float &cost, std::vector<int> *cells, SolveStats &stats)
+{
+    cost = INF;
+    if (cells)
+        cells->clear();
+    if (!openCell(a) || !openCell(b))
+        return false;
+    currentContraction();
+    float best;
+    int meet = upwardSearch(rankOf[a], rankOf[b], best, stats);
+    if (meet < 0)
+        return false;
+    cost = best + 0.5f * (grid[b].cost - grid[a].cost);
+    if (cells)
+    {
+        // a up to the meeting rank, then down to b
+        std::vector<int> climb;
+        for (int r = meet; r >= 0; r = sides[0].slots[r].pred)
+            climb.push_back(r);
+        cells->push_back(a);
+        for (size_t k = climb.size() - 1; k > 0; --k)
+            unpack(climb[k], climb[k - 1], *cells);
+        for (int r = meet; sides[1].slots[r].pred >= 0; r = sides[1].slots[r].pred)
+            unpack(r, sides[1].slots[r].pred, *cells);
+    }
+    return true;
+}
+
+float chDistance(int a, int b)
+{
+    SolveStats stats;
+    float cost;
+    query(a, b, cost, nullptr, stats);
+    return cost;
+}
+
+bool chPath(int a, int b, std::vector<int> &cells)
+{
+    SolveStats stats;
+    float cost;
+    return query(a, b, cost, &cells, stats);
+}
+
+SolveStats solveCH()
+{
+    currentContraction();
+    TraceScope trace("solveCH");
+    SolveStats stats;
+    double t0 = nowSeconds();
+    finalPathEdges.clear();
+    std::vector<int> cells;
+    float cost;
+    if (query(startCell, endCell, cost, &cells, stats))
+        for (size_t k = 1; k < cells.size(); ++k)
+        {
+            finalPathEdges.emplace_back(cells[k - 1], cells[k]);
+            pushEvent(cells[k - 1], cells[k], true, grid[cells[k]].cost);
+        }
+    stats.pathLength = finalPathEdges.size();
+    stats.seconds = nowSeconds() - t0;
+    return stats;
+}
+
+// ---- Maze file section ----
+
+// FNV-1a over 8-byte words (bytes for the tail): the grid checksum in front of
+// the section says which maze it is for, this one that the arrays survived
+static uint64_t hashWords(uint64_t h, const void *data, size_t n)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    for (; n >= 8; p += 8, n -= 8)
+    {
+        uint64_t w;
+        memcpy(&w, p, 8);
+        h = (h ^ w) * 1099511628211ULL;
+    }
+    for (; n; ++p, --n)
+        h = (h ^ *p) * 1099511628211ULL;
+    return h;
+}
+
+static uint64_t sectionChecksum(const int32_t head[2], const std::vector<int> &order, const std::vector<int> &start,
+                                const std::vector<Arc> &arcs)
+{
+    uint64_t h = hashWords(1469598103934665603ULL, head, 2 * sizeof(int32_t));
+    h = hashWords(h, order.data(), order.size() * sizeof(int));
+    h = hashWords(h, start.data(), start.size() * sizeof(int));
+    return hashWords(h, arcs.data(), arcs.size() * sizeof(Arc));
+}
+
+bool writeContraction(FILE *f)
+{
+    if (!contractionCurrent())
+    {
+        logAt(LL_ERROR, "contraction hierarchy is out of date, not saved");
+        return false;
+    }
+    int32_t head[2] = {gCols * gRows, (int32_t)upArcs.size()};
+    uint64_t checksum = sectionChecksum(head, cellOf, upStart, upArcs);
+    bool ok = fwrite(head, sizeof(head), 1, f) == 1 &&
+              fwrite(cellOf.data(), sizeof(int), cellOf.size(), f) == cellOf.size() &&
+              fwrite(upStart.data(), sizeof(int), upStart.size(), f) == upStart.size() &&
+              fwrite(upArcs.data(), sizeof(Arc), upArcs.size(), f) == upArcs.size() &&
+              fwrite(&checksum, sizeof(checksum), 1, f) == 1;
+    if (!ok)
+        logAt(LL_ERROR, "cannot write contraction hierarchy");
+    return ok;
+}
+
+bool readContraction(FILE *f)
+{
+    double t0 = nowSeconds();
+    const int N = gCols * gRows;
+    int32_t head[2];
+    if (fread(head, sizeof(head), 1, f) != 1 || head[0] != N || head[1] < 0)
+    {
+        logAt(LL_ERROR, "contraction hierarchy does not fit a %dx%d maze", gCols, gRows);
+        return false;
+    }
+    std::vector<int> order(N), rank(N, -1), start(N + 1);
+    std::vector<Arc> arcs(head[1]);
+    uint64_t checksum;
+    if (fread(order.data(), sizeof(int), N, f) != (size_t)N ||
+        fread(start.data(), sizeof(int), start.size(), f) != start.size() ||
+        fread(arcs.data(), sizeof(Arc), arcs.size(), f) != arcs.size() ||
+        fread(&checksum, sizeof(checksum), 1, f) != 1)
+    {
+        logAt(LL_ERROR, "contraction hierarchy is truncated, rebuilt on the next query");
+        return false;
+    }
+    // A damaged weight or shortcut still passes the checks below and would
+    // answer with wrong costs
+    if (checksum != sectionChecksum(head, order, start, arcs))
+    {
+        logAt(LL_ERROR, "contraction hierarchy is damaged, rebuilt on the next query");
+        return false;
+    }
+    // The order must be a permutation, offsets must stay in the arrays, and
+    // every arc must climb from an open cell with its skipped rank below both
+    // ends, which is what keeps unpacking finite
+    bool valid = start[0] == 0 && start[N] == head[1];
+    for (int r = 0; r < N && valid; ++r)
+    {
+        valid = order[r] >= 0 && order[r] < N && rank[order[r]] < 0 && start[r] <= start[r + 1];
+        if (valid)
+            rank[order[r]] = r;
+    }
+    for (int r = 0; r < N && valid; ++r)
+        for (int e = start[r]; e < start[r + 1] && valid; ++e)
+            valid = arcs[e].to > r && arcs[e].to < N && arcs[e].mid < r && arcs[e].mid >= -1 && arcs[e].w >= 0.0f &&
+                    !grid[order[r]].blocked && !grid[order[arcs[e].to]].blocked;
+    if (!valid)
+    {
+        logAt(LL_ERROR, "contraction hierarchy is corrupt, rebuilt on the next query");
+        return false;
+    }
+    cellOf.swap(order);
+    rankOf.swap(rank);
+    upStart.swap(start);
+    upArcs.swap(arcs);
+    info = ChInfo();
+    for (int u = 0; u < N; ++u)
+        info.cells += !grid[u].blocked;
+    info.upArcs = upArcs.size();
+    for (const Arc &a : upArcs)
+        info.shortcuts += a.mid >= 0;
+    info.loaded = true;
+    info.bytes = (cellOf.size() + rankOf.size() + upStart.size()) * sizeof(int) + upArcs.size() * sizeof(Arc);
+    info.seconds = nowSeconds() - t0;
+    chRevision = mazeRevision;
+    chCols = gCols;
+    chRows = gRows;
+    return true;
+}
@@ -0,0 +1,164 @@
+#include "../headers/dead_ends.h"
+#include "../headers/components.h"
+#include "../headers/parallel.h"
+#include "../headers/tracing.h"
+#include <chrono>
+
+static const int tileSize = 64;
+
+// Open neighbours still counted against each unsealed cell
+static std::vector<int> degree;
+
+static DeadEndFill cached;
+static unsigned int cachedRevision = ~0u;
+static int cachedCols = -1, cachedRows = -1;
+
+static double nowSeconds()
+{
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+static bool sealable(int u)
+{
+    return u != startCell && u != endCell && degree[u] <= 1;
+}
+
+// A sealed neighbour takes one open side from v; true when v becomes a dead end
+static bool loseNeighbour(const DeadEndFill &out, int v)
+{
+    if (out.sealed[v])
+        return false;
+    --degree[v];
+    return sealable(v);
+}
+
+// Blocked cells and other regions start sealed; everything else gets its degree
+static void prepare(DeadEndFill &out)
+{
+    int N = gCols * gRows;
+    out.sealed.assign(N, 0);
+    degree.assign(N, 0);
+    int startRegion = componentOf(startCell); // labels are built here, before any worker reads them
+    int bands = std::max(1, std::min(gRows, workerCount() * 4));
+    std::vector<int> open(bands, 0);
+    parallelFor(bands, [&](int i)
+                {
+        for (int u = gRows * i / bands * gCols; u < gRows * (i + 1) / bands * gCols; ++u)
+        {
+            int nb[4];
+            if (grid[u].blocked)
+            {
+                out.sealed[u] = 1;
+                continue;
+            }
+            open[i]++;
+            if (componentOf(u) != startRegion && u != startCell && u != endCell)
+                out.sealed[u] = 1;
+            else
+                degree[u] = openNeighbours(u, nb);
+        } });
+    out.openCells = 0;
+    for (int n : open)
+        out.openCells += n;
+}
+
+static void finish(DeadEndFill &out, double t0)
+{
+    out.viableCells = 0;
+    for (size_t u = 0; u < out.sealed.size(); ++u)
+        out.viableCells += !out.sealed[u];
+    out.seconds = nowSeconds() - t0;
+}
+
+void fillDeadEnds(DeadEndFill &out)
+{
+    TraceScope trace("fillDeadEnds");
+    double t0 = nowSeconds();
+    prepare(out);
+    std::vector<int> work;
+    for (int u = 0; u < gCols * gRows; ++u)
+        if (!out.sealed[u] && sealable(u))
+            work.push_back(u);
+    while (!work.empty())
+    {
+        int u = work.back(), nb[4];
+        work.pop_back();
+        if (out.sealed[u])
+            continue; // queued twice when its degree went 2 -> 1 -> 0
+        out.sealed[u] = 1;
+        for (int i = 0, k = openNeighbours(u, nb); i < k; ++i)
+            if (loseNeighbour(out, nb[i]))
+                work.push_back(nb[i]);
+    }
+    out.rounds = 1;
+    finish(out, t0);
+}
+
+// A tile only touches its own cells' seals and degrees; a neighbour across the
+// border goes to the tile's hand-off list and is decremented between rounds
+void fillDeadEndsTiled(DeadEndFill &out)
+{
+    TraceScope trace("fillDeadEndsTiled");
+    double t0 = nowSeconds();
+    prepare(out);
+    const int C = gCols, tilesX = (gCols + tileSize - 1) / tileSize;
+    const int tiles = tilesX * ((gRows + tileSize - 1) / tileSize);
+    auto tileOf = [&](int u)
+    { return u / C / tileSize * tilesX + u % C / tileSize; };
+    std::vector<std::vector<int>> work(tiles), handoff(tiles);
+    parallelFor(tiles, [&](int t)
+                {
+        int x0 = t % tilesX * tileSize, y0 = t / tilesX * tileSize;
+        for (int y = y0; y < std::min(gRows, y0 + tileSize); ++y)
+            for (int u = y * C + x0; u < y * C + std::min(C, x0 + tileSize); ++u)
+                if (!out.sealed[u] && sealable(u))
+                    work[t].push_back(u); });
+
+    out.rounds = 0;
+    for (bool pending = true; pending;)
+    {
+        out.rounds++;
+        parallelFor(tiles, [&](int t)
+                    {
+            std::vector<int> &w = work[t];
+            handoff[t].clear();
+            while (!w.empty())
+            {
+                int u = w.back(), nb[4];
+                w.pop_back();
+                if (out.sealed[u])
+                    continue;
+                out.sealed[u] = 1;
+                for (int i = 0, k = openNeighbours(u, nb); i < k; ++i)
+                {
+                    int v = nb[i];
+                    if (tileOf(v) != t)
+                        handoff[t].push_back(v);
+                    else if (loseNeighbour(out, v))
+                        w.push_back(v);
+                }
+            } });
+        pending = false;
+        for (const std::vector<int> &h : handoff)
+            for (int v : h)
+                if (loseNeighbour(out, v))
+                {
+                    work[tileOf(v)].push_back(v);
+                    pending = true;
+                }
+    }
+    finish(out, t0);
+}
+
+const DeadEndFill &currentDeadEndFill()
+{
+    if (cachedRevision != mazeRevision || cachedCols != gCols || cachedRows != gRows)
+    {
+        fillDeadEndsTiled(cached);
+        cachedRevision = mazeRevision;
+        cachedCols = gCols;
+        cachedRows = gRows;
+    }
+    return cached;
+}
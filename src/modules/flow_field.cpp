@@ -0,0 +1,209 @@
+#include "../headers/flow_field.h"
+#include "../headers/maze_file.h"
+#include "../headers/tracing.h"
+#include <chrono>
+
+static const float INF = std::numeric_limits<float>::infinity();
+static const int dirs[4][3] = {{0, -1, 0}, {1, 0, 1}, {0, 1, 2}, {-1, 0, 3}};
+// End cells whose fields are kept; "New Start/End Points" picks among four corners
+static const int slotCount = 4;
+
+struct Field
+{
+    int end = -1, cols = -1, rows = -1;
+    unsigned int revision = ~0u;
+    uint64_t checksum = 0;   // of the walls, obstacles and terrain it was built on
+    unsigned long lastUse = 0;
+    std::vector<float> dist;
+    std::vector<uint8_t> hop; // next step's direction, four cells per byte
+    FlowInfo info;
+};
+
+static Field fields[slotCount];
+static unsigned long useClock = 0;
+// mazeChecksum of the current revision, computed once per revision
+static unsigned int checkedRevision = ~0u;
+static uint64_t checkedSum = 0;
+
+static double nowSeconds()
+{
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+static int hopOf(const Field &f, int c)
+{
+    return (f.hop[c >> 2] >> ((c & 3) * 2)) & 3;
+}
+
+static void setHop(Field &f, int c, int d)
+{
+    uint8_t &b = f.hop[c >> 2];
+    b = (uint8_t)((b & ~(3 << ((c & 3) * 2))) | (d << ((c & 3) * 2)));
+}
+
+// Backwards from the end: u reaches a settled v when u's wall toward v is open,
+// at v's cost. Blocked cells belong to no region, so like the other solvers
+// the field gives them no path, as start or end.
+static void build(Field &f)
+{
+    TraceScope trace("buildFlowField");
+    double t0 = nowSeconds();
+    const int N = gCols * gRows;
+    f.dist.assign(N, INF);
+    f.hop.assign((N + 3) / 4, 0);
+    f.end = endCell;
+    f.cols = gCols;
+    f.rows = gRows;
+    f.info = FlowInfo();
+    bool unit = true;
+    for (const Cell &c : grid)
+        unit = unit && c.cost == 1.0f;
+
+    auto relax = [&](int v, auto &&push)
+    {
+        int x = v % gCols, y = v / gCols;
+        for (auto &d : dirs)
+        {
+            int u = index(x + d[0], y + d[1]);
+            int toV = (d[2] + 2) % 4;
+            if (u < 0 || grid[u].walls[toV] || grid[u].blocked)
+                continue;
+            float du = f.dist[v] + grid[v].cost;
+            if (du < f.dist[u])
+            {
+                f.dist[u] = du;
+                setHop(f, u, toV);
+                push(u, du);
+            }
+        }
+    };
+
+    // A blocked end is reached by nothing, itself included
+    bool endOpen = !grid[endCell].blocked;
+    if (endOpen && unit)
+    {
+        // Every step costs 1: first reached is cheapest
+        f.dist[endCell] = 0.0f;
+        std::vector<int> queue;
+        queue.reserve(N);
+        queue.push_back(endCell);
+        for (size_t head = 0; head < queue.size(); ++head)
+            relax(queue[head], [&](int u, float) { queue.push_back(u); });
+        f.info.reached = (int)queue.size();
+    }
+    else if (endOpen)
+    {
+        using P = std::pair<float, int>;
+        std::priority_queue<P, std::vector<P>, std::greater<P>> open;
+        f.dist[endCell] = 0.0f;
+        open.push({0.0f, endCell});
+        while (!open.empty())
+        {
+            auto [d, v] = open.top();
+            open.pop();
+            if (d != f.dist[v])
+                continue;
+            f.info.reached++;
+            relax(v, [&](int u, float du) { open.push({du, u}); });
+        }
+    }
+    f.info.bytes = f.dist.capacity() * sizeof(float) + f.hop.capacity();
+    f.info.seconds = nowSeconds() - t0;
+}
+
+static bool matches(const Field &f)
+{
+    return f.end == endCell && f.cols == gCols && f.rows == gRows && (int)f.dist.size() == gCols * gRows;
+}
+
+bool flowFieldCurrent()
+{
+    for (const Field &f : fields)
+        if (matches(f) && f.revision == mazeRevision)
+            return true;
+    return false;
+}
+
+static Field &fieldToEnd()
+{
+    if (checkedRevision != mazeRevision)
+    {
+        // Comparing is a pass over the grid, far cheaper than a search over it
+        checkedSum = mazeChecksum();
+        checkedRevision = mazeRevision;
+    }
+    Field *slot = nullptr;
+    for (Field &f : fields)
+        if (matches(f))
+            slot = &f;
+    if (slot && slot->revision != mazeRevision && slot->checksum == checkedSum)
+        slot->revision = mazeRevision; // only the start or end moved since
+    if (!slot || slot->revision != mazeRevision)
+    {
+        if (!slot)
+        {
+            slot = &fields[0];
+            for (Field &f : fields)
+                if (f.lastUse < slot->lastUse)
+                    slot = &f;
+        }
+        build(*slot);
+        slot->revision = mazeRevision;
+        slot->checksum = checkedSum;
+    }
+    slot->lastUse = ++useClock;
+    return *slot;
+}
+
+const FlowInfo &currentFlowField()
+{
+    return fieldToEnd().info;
+}
+
+float flowDistance(int from)
+{
+    if (from < 0 || from >= gCols * gRows)
+        return INF;
+    return fieldToEnd().dist[from];
+}
+
+bool flowPath(int from, std::vector<int> &cells)
+{
+    cells.clear();
+    if (from < 0 || from >= gCols * gRows)
+        return false;
+    const Field &f = fieldToEnd();
+    if (f.dist[from] == INF)
+        return false;
+    // Each step lowers the distance by at least 1, so this ends at the end
+    for (int c = from;;)
+    {
+        cells.push_back(c);
+        if (c == f.end)
+            break;
+        const int *d = dirs[hopOf(f, c)];
+        c = index(c % gCols + d[0], c / gCols + d[1]);
+    }
+    return true;
+}
+
+SolveStats solveFlowField()
+{
+    fieldToEnd();
+    TraceScope trace("solveFlowField");
+    SolveStats stats;
+    double t0 = nowSeconds();
+    finalPathEdges.clear();
+    std::vector<int> cells;
+    if (flowPath(startCell, cells))
+        for (size_t k = 1; k < cells.size(); ++k)
+        {
+            finalPathEdges.emplace_back(cells[k - 1], cells[k]);
+            pushEvent(cells[k - 1], cells[k], true, grid[cells[k]].cost);
+        }
+    stats.nodesExpanded = cells.size();
+    stats.pathLength = finalPathEdges.size();
+    stats.seconds = nowSeconds() - t0;
+    return stats;
+}
@@ -0,0 +1,105 @@
+#include "../headers/frame_pacing.h"
+#include <atomic>
+
+// Frames still owed after the last damage. ImGui needs a couple of frames after
+// an input event to settle hover/active state, hence the default of 3.
+static std::atomic<int> pendingFrames{3};
+static const double idleTimeout = 1.0; // seconds between idle wake-ups
+
+static FrameStats stats;
+static double statsStart = 0.0, statsCpuStart = 0.0;
+static int statsFrames = 0;
+
+// Process CPU time in seconds (all threads)
+static double processCpuSeconds()
+{
+#ifdef _WIN32
+    FILETIME created, exited, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user))
+        return 0.0;
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+    return (double)(k.QuadPart + u.QuadPart) * 1e-7;
+#else
+    return (double)std::clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+// Any user input or window damage owes a few frames. These are installed before
+// ImGui_ImplGlfw_InitForOpenGL, which chains to them from its own callbacks.
+void installDamageCallbacks(GLFWwindow *window)
+{
+    glfwSetCursorPosCallback(window, [](GLFWwindow *, double, double)
+                             { requestRedraw(); });
+    glfwSetMouseButtonCallback(window, [](GLFWwindow *, int, int, int)
+                               { requestRedraw(); });
+    glfwSetScrollCallback(window, [](GLFWwindow *, double, double)
+                          { requestRedraw(); });
+    glfwSetKeyCallback(window, [](GLFWwindow *, int, int, int, int)
+                       { requestRedraw(); });
+    glfwSetCharCallback(window, [](GLFWwindow *, unsigned int)
+                        { requestRedraw(); });
+    glfwSetWindowFocusCallback(window, [](GLFWwindow *, int)
+                               { requestRedraw(); });
+    glfwSetCursorEnterCallback(window, [](GLFWwindow *, int)
+                               { requestRedraw(); });
+    glfwSetWindowRefreshCallback(window, [](GLFWwindow *)
+                                 { requestRedraw(); });
+}
+
+// Safe to call from worker threads: wakes the main loop out of glfwWaitEventsTimeout
+void requestRedraw(int frames)
+{
+    int cur = pendingFrames.load();
+    while (cur < frames && !pendingFrames.compare_exchange_weak(cur, frames))
+    {
+    }
+    glfwPostEmptyEvent();
+}
+
+// Pumps events, blocking while the scene is static. Returns true when a frame
+// should be rendered and accounts it in the fps/CPU readout.
+bool waitForFrame(bool animating)
+{
+    // Nothing is visible while minimised; restoring fires the refresh callback
+    bool iconified = glfwGetWindowAttrib(gWindow, GLFW_ICONIFIED) != 0;
+    if ((animating || pendingFrames.load() > 0) && !iconified)
+        glfwPollEvents();
+    else
+        glfwWaitEventsTimeout(idleTimeout);
+
+    double now = glfwGetTime();
+    if (statsStart == 0.0)
+    {
+        statsStart = now;
+        statsCpuStart = processCpuSeconds();
+    }
+    else if (now - statsStart >= 1.0)
+    {
+        double cpu = processCpuSeconds();
+        float fps = (float)(statsFrames / (now - statsStart));
+        float cpuPercent = (float)(100.0 * (cpu - statsCpuStart) / (now - statsStart));
+        // Redraw once if the readout changed so an idle window still shows ~0 fps
+        if ((int)fps != (int)stats.fps || (int)cpuPercent != (int)stats.cpuPercent)
+            pendingFrames.store(std::max(pendingFrames.load(), 1));
+        stats.fps = fps;
+        stats.cpuPercent = cpuPercent;
+        statsStart = now;
+        statsCpuStart = cpu;
+        statsFrames = 0;
+    }
+
+    bool draw = (animating || pendingFrames.load() > 0) && !iconified;
+    if (draw)
+    {
+        if (pendingFrames.load() > 0)
+            pendingFrames.fetch_sub(1);
+        statsFrames++;
+    }
+    return draw;
+}
+
+const FrameStats &frameStats() { return stats; }
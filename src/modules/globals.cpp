@@ -20,18 +20,25 @@ std::vector<std::tuple<int, int, bool, float>> events;
 std::vector<std::pair<int, int>> finalPathEdges;
 std::vector<float> successVertices; // pairs of (x,y) points in grid space
 std::vector<float> failureVertices;
+size_t successSynced = 0, failureSynced = 0;
 size_t eventIndex = 0;
 bool stepMode = false;
 
 unsigned int successVAO = 0, successVBO = 0, failureVAO = 0, failureVBO = 0;
 int startCell = 0, endCell = 0;
+unsigned int mazeRevision = 0;
 std::mt19937 rng(std::random_device{}());
 
 unsigned int shader = 0;
 glm::mat4 proj;
+float camZoom = 1.0f, camX = 0.0f, camY = 0.0f;
 
 float speedMultiplier = 1.0f;
 float obstacleDensity = 0.15f;
+float terrainMaxCost = 8.0f;
+bool lodEnabled = true;
+bool pruneDeadEnds = false;
+bool perfectMazes = false;
 
 // Wall and UI icon textures
 GLuint texWall = 0; // legacy, unused
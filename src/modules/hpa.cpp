@@ -0,0 +1,452 @@
+#include "../headers/hpa.h"
+#include "../headers/components.h"
+#include "../headers/parallel.h"
+#include "../headers/tracing.h"
+#include <chrono>
+
+static const int dirs[4][3] = {{0, -1, 0}, {1, 0, 1}, {0, 1, 2}, {-1, 0, 3}};
+static const float INF = std::numeric_limits<float>::infinity();
+static const int longEntrance = 6; // runs this long get a node at each end
+
+struct Cluster
+{
+    std::vector<int> nodes;     // entrance cells inside this cluster
+    std::vector<int> edgeStart; // node i's edges are [edgeStart[i], edgeStart[i + 1])
+    std::vector<int> edgeTo;    // node slot within the cluster
+    std::vector<float> edgeCost;
+    bool uniform = true; // every cell costs 1, so BFS gives the costs
+    // Abstract search scratch per node, valid where seen == searchEpoch; kept
+    // here so a node's edges and their targets' scratch share the cluster's memory
+    std::vector<int> seen, from;
+    std::vector<float> g;
+};
+
+static HpaInfo info;
+static std::vector<Cluster> clusters;
+static std::vector<int> nodeSlot; // position in its cluster's node list, -1 for other cells
+static int clustersX = 0, clustersY = 0;
+static std::vector<char> dirtyFlag;
+static std::vector<int> dirtyList;
+static unsigned int hpaRevision = ~0u;
+static int hpaCols = -1, hpaRows = -1;
+static int searchEpoch = 0; // bumped per abstract search, see Cluster::seen
+
+static double nowSeconds()
+{
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+static int clusterOf(int cell)
+{
+    return cell / gCols / HPA_CLUSTER * clustersX + cell % gCols / HPA_CLUSTER;
+}
+
+// Cells [x0, x1) x [y0, y1) of a cluster
+struct Rect
+{
+    int x0, y0, x1, y1;
+    int width() const { return x1 - x0; }
+    bool contains(int x, int y) const { return x >= x0 && x < x1 && y >= y0 && y < y1; }
+    int local(int cell) const { return (cell / gCols - y0) * width() + cell % gCols - x0; }
+    int global(int l) const { return (y0 + l / width()) * gCols + x0 + l % width(); }
+};
+
+static Rect rectOf(int c)
+{
+    int x0 = c % clustersX * HPA_CLUSTER, y0 = c / clustersX * HPA_CLUSTER;
+    return {x0, y0, std::min(gCols, x0 + HPA_CLUSTER), std::min(gRows, y0 + HPA_CLUSTER)};
+}
+
+// Walks one border of rect r, cell a on this side and b across, and appends the
+// node cells of every entrance run to `out`. Both clusters of a border see the same
+// runs, so they pick the two halves of the same pairs.
+static void borderEntrances(const Rect &r, int side, std::vector<int> &out)
+{
+    const int C = gCols;
+    bool vertical = side == 1 || side == 3;
+    int len = vertical ? r.y1 - r.y0 : r.width();
+    int fixed = side == 0 ? r.y0 : side == 1 ? r.x1 - 1 : side == 2 ? r.y1 - 1 : r.x0;
+    if ((side == 0 && fixed == 0) || (side == 3 && fixed == 0) || (side == 1 && fixed == C - 1) ||
+        (side == 2 && fixed == gRows - 1))
+        return;
+    auto cellAt = [&](int i)
+    { return vertical ? (r.y0 + i) * C + fixed : fixed * C + r.x0 + i; };
+    // From a border cell to the cell across it, and to the next one along it
+    int offset = side == 0 ? -C : side == 1 ? 1 : side == 2 ? C : -1, step = vertical ? C : 1;
+    auto joined = [](int a, int b)
+    { return openBetween(a, b) && !grid[a].blocked && !grid[b].blocked; };
+    auto across = [&](int a)
+    { return joined(a, a + offset); };
+    auto along = [&](int a)
+    { return joined(a, a + step) && joined(a + offset, a + offset + step); };
+    for (int i = 0; i < len;)
+    {
+        if (!across(cellAt(i)))
+        {
+            ++i;
+            continue;
+        }
+        int j = i;
+        while (j + 1 < len && across(cellAt(j + 1)) && along(cellAt(j)))
+            ++j;
+        // Short runs by their middle, long ones (open ground) by both ends
+        if (j - i + 1 < longEntrance)
+            out.push_back(cellAt((i + j) / 2));
+        else
+        {
+            out.push_back(cellAt(i));
+            out.push_back(cellAt(j));
+        }
+        i = j + 1;
+    }
+}
+
+struct LocalSearch
+{
+    std::vector<float> dist;
+    std::vector<int> parent; // local index, -1 at the source
+    size_t expanded = 0, relaxed = 0, peak = 0;
+};
+
+// Dijkstra inside one cluster, A* when a target is given. Forward costs run from
+// src; reverse costs run from every cell to src, walking the moves backwards.
+// Either way a step pays the cost of the cell it enters, as solveAStar does.
+// With recordEvents the relaxations go to the animation.
+static void localSearch(const Rect &r, int src, bool reverse, int target, bool uniform, LocalSearch &out,
+                        bool recordEvents = false)
+{
+    int n = r.width() * (r.y1 - r.y0);
+    out.dist.assign(n, INF);
+    out.parent.assign(n, -1);
+    out.expanded = out.relaxed = out.peak = 0;
+    int tx = target >= 0 ? target % gCols : 0, ty = target >= 0 ? target / gCols : 0;
+    auto h = [&](int cell)
+    { return target < 0 ? 0.0f : (float)(abs(cell % gCols - tx) + abs(cell / gCols - ty)); };
+    auto relax = [&](int u, int d, float du, auto &&push)
+    {
+        int x = u % gCols, y = u / gCols, vx = x + dirs[d][0], vy = y + dirs[d][1];
+        if (!r.contains(vx, vy))
+            return;
+        int v = vy * gCols + vx;
+        if (grid[v].blocked)
+            return;
+        // forward: u -> v through u's wall; reverse: v -> u through v's wall
+        if (reverse ? grid[v].walls[(d + 2) % 4] : grid[u].walls[d])
+            return;
+        float nd = du + (reverse ? grid[u].cost : grid[v].cost);
+        int lv = r.local(v);
+        if (nd >= out.dist[lv])
+            return;
+        out.dist[lv] = nd;
+        out.parent[lv] = r.local(u);
+        out.relaxed++;
+        if (recordEvents)
+            pushEvent(u, v, false, grid[v].cost);
+        push(v, nd);
+    };
+    out.dist[r.local(src)] = 0.0f;
+    if (uniform && target < 0)
+    {
+        // Every step costs 1: a FIFO queue settles cells in cost order
+        std::vector<int> queue{src};
+        for (size_t qi = 0; qi < queue.size(); ++qi)
+        {
+            int u = queue[qi];
+            out.expanded++;
+            for (int d = 0; d < 4; ++d)
+                relax(u, d, out.dist[r.local(u)], [&](int v, float)
+                      { queue.push_back(v); });
+        }
+        out.peak = queue.size();
+        return;
+    }
+    using P = std::pair<float, int>;
+    std::priority_queue<P, std::vector<P>, std::greater<P>> open;
+    open.push({h(src), src});
+    while (!open.empty())
+    {
+        out.peak = std::max(out.peak, open.size());
+        auto [f, u] = open.top();
+        open.pop();
+        float du = out.dist[r.local(u)];
+        if (f != du + h(u))
+            continue;
+        out.expanded++;
+        if (u == target)
+            break;
+        for (int d = 0; d < 4; ++d)
+            relax(u, d, du, [&](int v, float nd)
+                  { open.push({nd + h(v), v}); });
+    }
+}
+
+// Node list and node-to-node costs of one cluster; writes only its own cells
+static void buildCluster(int c)
+{
+    Cluster &cl = clusters[c];
+    Rect r = rectOf(c);
+    for (int y = r.y0; y < r.y1; ++y)
+        for (int x = r.x0; x < r.x1; ++x)
+            nodeSlot[y * gCols + x] = -1;
+    cl.nodes.clear();
+    for (int side = 0; side < 4; ++side)
+        borderEntrances(r, side, cl.nodes);
+    // Corner cells can be picked by two borders
+    std::sort(cl.nodes.begin(), cl.nodes.end());
+    cl.nodes.erase(std::unique(cl.nodes.begin(), cl.nodes.end()), cl.nodes.end());
+    cl.uniform = true;
+    for (int y = r.y0; y < r.y1 && cl.uniform; ++y)
+        for (int x = r.x0; x < r.x1; ++x)
+            if (grid[y * gCols + x].cost != 1.0f)
+            {
+                cl.uniform = false;
+                break;
+            }
+    int n = (int)cl.nodes.size();
+    for (int i = 0; i < n; ++i)
+        nodeSlot[cl.nodes[i]] = i;
+    cl.edgeStart.assign(1, 0);
+    cl.edgeTo.clear();
+    cl.edgeCost.clear();
+    LocalSearch ls;
+    for (int i = 0; i < n; ++i)
+    {
+        localSearch(r, cl.nodes[i], false, -1, cl.uniform, ls);
+        for (int j = 0; j < n; ++j)
+        {
+            float d = ls.dist[r.local(cl.nodes[j])];
+            if (j != i && d < INF)
+            {
+                cl.edgeTo.push_back(j);
+                cl.edgeCost.push_back(d);
+            }
+        }
+        cl.edgeStart.push_back((int)cl.edgeTo.size());
+    }
+    cl.seen.assign(n, 0);
+    cl.from.assign(n, -1);
+    cl.g.assign(n, INF);
+}
+
+static void finishUpdate(double t0, int rebuilt)
+{
+    info.nodes = 0;
+    info.intraEdges = 0;
+    info.bytes = nodeSlot.size() * sizeof(int) + clusters.size() * sizeof(Cluster);
+    for (const Cluster &cl : clusters)
+    {
+        info.nodes += (int)cl.nodes.size();
+        info.intraEdges += cl.edgeTo.size();
+        info.bytes += cl.nodes.size() * 5 * sizeof(int) + cl.edgeTo.size() * (sizeof(int) + sizeof(float));
+    }
+    info.rebuilt = rebuilt;
+    info.seconds = nowSeconds() - t0;
+}
+
+static void buildAll()
+{
+    TraceScope trace("buildHpa");
+    double t0 = nowSeconds();
+    const int N = gCols * gRows;
+    clustersX = (gCols + HPA_CLUSTER - 1) / HPA_CLUSTER;
+    clustersY = (gRows + HPA_CLUSTER - 1) / HPA_CLUSTER;
+    info = HpaInfo();
+    info.clusters = clustersX * clustersY;
+    clusters.assign(info.clusters, Cluster());
+    nodeSlot.assign(N, -1);
+    dirtyFlag.assign(info.clusters, 0);
+    dirtyList.clear();
+    searchEpoch = 0;
+    parallelFor(info.clusters, buildCluster);
+    finishUpdate(t0, info.clusters);
+}
+
+const HpaInfo &currentHpa()
+{
+    if (hpaRevision != mazeRevision || hpaCols != gCols || hpaRows != gRows)
+    {
+        buildAll();
+        hpaRevision = mazeRevision;
+        hpaCols = gCols;
+        hpaRows = gRows;
+    }
+    else if (!dirtyList.empty())
+    {
+        TraceScope trace("updateHpa");
+        double t0 = nowSeconds();
+        parallelFor((int)dirtyList.size(), [](int i)
+                    { buildCluster(dirtyList[i]); });
+        for (int c : dirtyList)
+            dirtyFlag[c] = 0;
+        int rebuilt = (int)dirtyList.size();
+        dirtyList.clear();
+        finishUpdate(t0, rebuilt);
+    }
+    return info;
+}
+
+void hpaCellChanged(int cell)
+{
+    // As with the region labels, only an abstraction one edit behind is patched
+    if (hpaRevision + 1 != mazeRevision || hpaCols != gCols || hpaRows != gRows || cell < 0 ||
+        cell >= gCols * gRows)
+        return;
+    int x = cell % gCols, y = cell / gCols, cx = x / HPA_CLUSTER, cy = y / HPA_CLUSTER;
+    auto mark = [&](int mx, int my)
+    {
+        if (mx < 0 || my < 0 || mx >= clustersX || my >= clustersY || dirtyFlag[my * clustersX + mx])
+            return;
+        dirtyFlag[my * clustersX + mx] = 1;
+        dirtyList.push_back(my * clustersX + mx);
+    };
+    mark(cx, cy);
+    if (x % HPA_CLUSTER == 0)
+        mark(cx - 1, cy);
+    if (x % HPA_CLUSTER == HPA_CLUSTER - 1)
+        mark(cx + 1, cy);
+    if (y % HPA_CLUSTER == 0)
+        mark(cx, cy - 1);
+    if (y % HPA_CLUSTER == HPA_CLUSTER - 1)
+        mark(cx, cy + 1);
+    hpaRevision = mazeRevision;
+}
+
+// Cell path from p to q inside r, appended without p itself
+static void refine(const Rect &r, int p, int q, std::vector<int> &path, SolveStats &stats)
+{
+    LocalSearch ls;
+    localSearch(r, p, false, q, false, ls, true);
+    stats.nodesExpanded += ls.expanded;
+    stats.edgesRelaxed += ls.relaxed;
+    stats.peakFrontier = std::max(stats.peakFrontier, ls.peak);
+    size_t mark = path.size();
+    for (int l = r.local(q); l != r.local(p); l = ls.parent[l])
+        path.push_back(r.global(l));
+    std::reverse(path.begin() + mark, path.end());
+}
+
+SolveStats solveHPA()
+{
+    currentHpa();
+    TraceScope trace("solveHPA");
+    SolveStats stats;
+    double t0 = nowSeconds();
+    finalPathEdges.clear();
+    int sc = clusterOf(startCell), ec = clusterOf(endCell);
+    Rect sr = rectOf(sc), er = rectOf(ec);
+    LocalSearch fromStart, toEnd;
+    localSearch(sr, startCell, false, -1, clusters[sc].uniform, fromStart);
+    localSearch(er, endCell, true, -1, clusters[ec].uniform, toEnd);
+    stats.nodesExpanded = fromStart.expanded + toEnd.expanded;
+
+    // Start and end in the same or touching clusters: a search over both
+    // clusters' box competes with the abstract route, so short hops are not
+    // forced through entrance nodes
+    Rect direct = {std::min(sr.x0, er.x0), std::min(sr.y0, er.y0), std::max(sr.x1, er.x1), std::max(sr.y1, er.y1)};
+    float best = INF;
+    int bestVia = -1; // -1: the direct search, else the last node before the end
+    if (abs(sc % clustersX - ec % clustersX) <= 1 && abs(sc / clustersX - ec / clustersX) <= 1)
+    {
+        LocalSearch near;
+        localSearch(direct, startCell, false, endCell, false, near);
+        best = near.dist[direct.local(endCell)];
+        stats.nodesExpanded += near.expanded;
+    }
+    int ex = endCell % gCols, ey = endCell / gCols;
+    auto h = [&](int cell)
+    { return (float)(abs(cell % gCols - ex) + abs(cell / gCols - ey)); };
+
+    if (++searchEpoch == 0)
+    {
+        for (Cluster &cl : clusters)
+            std::fill(cl.seen.begin(), cl.seen.end(), 0);
+        searchEpoch = 1;
+    }
+    // Open entries are node cells; scratch lives with the node's cluster
+    using P = std::pair<float, int>;
+    std::priority_queue<P, std::vector<P>, std::greater<P>> open;
+    auto reach = [&](Cluster &cl, int j, float g, int from)
+    {
+        if (cl.seen[j] == searchEpoch && g >= cl.g[j])
+            return;
+        cl.seen[j] = searchEpoch;
+        cl.g[j] = g;
+        cl.from[j] = from;
+        open.push({g + h(cl.nodes[j]), cl.nodes[j]});
+        stats.edgesRelaxed++;
+    };
+    for (int j = 0; j < (int)clusters[sc].nodes.size(); ++j)
+    {
+        float d = fromStart.dist[sr.local(clusters[sc].nodes[j])];
+        if (d < INF)
+            reach(clusters[sc], j, d, -1);
+    }
+    size_t abstractExpanded = 0;
+    while (!open.empty())
+    {
+        stats.peakFrontier = std::max(stats.peakFrontier, open.size());
+        auto [f, u] = open.top();
+        open.pop();
+        if (f >= best)
+            break;
+        int c = clusterOf(u), i = nodeSlot[u];
+        Cluster &cl = clusters[c];
+        float gu = cl.g[i];
+        if (f != gu + h(u))
+        {
+            stats.stalePops++;
+            continue;
+        }
+        abstractExpanded++;
+        if (c == ec && gu + toEnd.dist[er.local(u)] < best)
+        {
+            best = gu + toEnd.dist[er.local(u)];
+            bestVia = u;
+        }
+        for (int e = cl.edgeStart[i]; e < cl.edgeStart[i + 1]; ++e)
+            reach(cl, cl.edgeTo[e], gu + cl.edgeCost[e], u);
+        int x = u % gCols, y = u / gCols;
+        for (auto &d : dirs)
+        {
+            int v = index(x + d[0], y + d[1]);
+            if (v >= 0 && nodeSlot[v] >= 0 && clusterOf(v) != c && !grid[u].walls[d[2]] && !grid[v].blocked)
+                reach(clusters[clusterOf(v)], nodeSlot[v], gu + grid[v].cost, u);
+        }
+    }
+    stats.nodesExpanded += abstractExpanded;
+
+    if (best < INF)
+    {
+        // Abstract path end -> start, then refined cluster by cluster
+        std::vector<int> path{startCell}, hops{endCell};
+        for (int u = bestVia; u >= 0; u = clusters[clusterOf(u)].from[nodeSlot[u]])
+            hops.push_back(u);
+        hops.push_back(startCell);
+        std::reverse(hops.begin(), hops.end());
+        if (bestVia < 0)
+            refine(direct, startCell, endCell, path, stats);
+        else
+            for (size_t k = 1; k < hops.size(); ++k)
+            {
+                int p = hops[k - 1], q = hops[k];
+                if (p == q)
+                    continue;
+                if (clusterOf(p) != clusterOf(q))
+                    path.push_back(q); // entrance pair: one step across the border
+                else
+                    refine(rectOf(clusterOf(p)), p, q, path, stats);
+            }
+        for (size_t k = 1; k < path.size(); ++k)
+            finalPathEdges.emplace_back(path[k - 1], path[k]);
+    }
+    std::set<std::pair<int, int>> pathSet(finalPathEdges.begin(), finalPathEdges.end());
+    for (auto &e : events)
+        if (pathSet.count({std::get<0>(e), std::get<1>(e)}))
+            std::get<2>(e) = true;
+    stats.pathLength = finalPathEdges.size();
+    stats.scratchBytes = (fromStart.dist.size() + toEnd.dist.size()) * (sizeof(float) + sizeof(int)) +
+                         stats.peakFrontier * sizeof(P);
+    stats.seconds = nowSeconds() - t0;
+    return stats;
+}
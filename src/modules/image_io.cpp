@@ -0,0 +1,384 @@
+#include "../headers/image_io.h"
+#include "../headers/logging.h"
+#include "../headers/parallel.h"
+#include "../headers/tracing.h"
+
+// ---------- PNG ----------
+
+static uint32_t crc32(uint32_t crc, const uint8_t *p, size_t n)
+{
+    static uint32_t table[256];
+    static bool init = false;
+    if (!init)
+    {
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+        init = true;
+    }
+    crc = ~crc;
+    while (n--)
+        crc = table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static uint32_t adler32(const uint8_t *p, size_t n)
+{
+    uint32_t a = 1, b = 0;
+    while (n)
+    {
+        size_t k = std::min<size_t>(n, 5552); // largest run without overflow
+        n -= k;
+        while (k--)
+        {
+            a += *p++;
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+// LSB-first bit packer used by deflate
+struct BitWriter
+{
+    std::vector<uint8_t> out;
+    uint32_t acc = 0;
+    int bits = 0;
+    void put(uint32_t v, int n)
+    {
+        acc |= v << bits;
+        bits += n;
+        while (bits >= 8)
+        {
+            out.push_back((uint8_t)acc);
+            acc >>= 8;
+            bits -= 8;
+        }
+    }
+    // Huffman codes go out most-significant bit first
+    void putCode(uint32_t code, int n)
+    {
+        uint32_t r = 0;
+        for (int i = 0; i < n; ++i)
+            r |= ((code >> i) & 1) << (n - 1 - i);
+        put(r, n);
+    }
+    void align()
+    {
+        if (bits)
+            put(0, 8 - bits);
+    }
+};
+
+static void putLiteral(BitWriter &bw, int v)
+{
+    if (v < 144)
+        bw.putCode(0x30 + v, 8);
+    else if (v < 256)
+        bw.putCode(0x190 + v - 144, 9);
+    else if (v < 280)
+        bw.putCode(v - 256, 7);
+    else
+        bw.putCode(0xC0 + v - 280, 8);
+}
+
+static void putMatch(BitWriter &bw, int len, int dist)
+{
+    static const int lenBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    static const int lenExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                     3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+    static const int distBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129,
+                                     193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097,
+                                     6145, 8193, 12289, 16385, 24577};
+    int l = 28;
+    while (lenBase[l] > len)
+        --l;
+    putLiteral(bw, 257 + l);
+    bw.put(len - lenBase[l], lenExtra[l]);
+    int d = 29;
+    while (distBase[d] > dist)
+        --d;
+    bw.putCode(d, 5);
+    bw.put(dist - distBase[d], d < 4 ? 0 : d / 2 - 1);
+}
+
+// Fixed-Huffman deflate of data[begin, end). Matches only try the previous byte
+// and the byte one scanline up, which is where flat maze images repeat. Each
+// chunk ends on a byte boundary (empty stored block, like a zlib sync flush) so
+// chunks compressed on different threads can simply be concatenated.
+static void deflateChunk(const uint8_t *data, size_t begin, size_t end, size_t stride, BitWriter &bw)
+{
+    bw.put(0, 1); // not final
+    bw.put(1, 2); // fixed Huffman
+    size_t i = begin;
+    while (i < end)
+    {
+        int bestLen = 0, bestDist = 0;
+        const size_t dists[2] = {1, stride};
+        for (size_t dist : dists)
+        {
+            if (dist > i || dist > 32768)
+                continue;
+            size_t maxLen = std::min<size_t>(258, end - i);
+            size_t len = 0;
+            while (len < maxLen && data[i + len] == data[i + len - dist])
+                ++len;
+            if ((int)len > bestLen)
+            {
+                bestLen = (int)len;
+                bestDist = (int)dist;
+            }
+        }
+        if (bestLen >= 3)
+        {
+            putMatch(bw, bestLen, bestDist);
+            i += bestLen;
+        }
+        else
+        {
+            putLiteral(bw, data[i++]);
+        }
+    }
+    putLiteral(bw, 256); // end of block
+    bw.put(0, 1);        // stored, not final
+    bw.put(0, 2);
+    bw.align();
+    bw.put(0x0000, 16);
+    bw.put(0xFFFF, 16);
+}
+
+static std::vector<uint8_t> zlibCompress(const std::vector<uint8_t> &raw, size_t stride)
+{
+    const size_t chunk = std::max<size_t>(stride, 1) * 64; // whole scanlines per job
+    int chunks = (int)((raw.size() + chunk - 1) / chunk);
+    std::vector<BitWriter> parts(chunks);
+    parallelFor(chunks, [&](int c)
+                { deflateChunk(raw.data(), c * chunk, std::min(raw.size(), (c + 1) * chunk), stride, parts[c]); });
+
+    std::vector<uint8_t> z = {0x78, 0x01};
+    for (auto &p : parts)
+        z.insert(z.end(), p.out.begin(), p.out.end());
+    BitWriter tail; // empty final block
+    tail.put(1, 1);
+    tail.put(1, 2);
+    putLiteral(tail, 256);
+    tail.align();
+    z.insert(z.end(), tail.out.begin(), tail.out.end());
+    uint32_t a = adler32(raw.data(), raw.size());
+    for (int s = 24; s >= 0; s -= 8)
+        z.push_back((uint8_t)(a >> s));
+    return z;
+}
+
+static void writeChunk(FILE *f, const char *type, const std::vector<uint8_t> &data)
+{
+    uint8_t len[4] = {(uint8_t)(data.size() >> 24), (uint8_t)(data.size() >> 16),
+                      (uint8_t)(data.size() >> 8), (uint8_t)data.size()};
+    fwrite(len, 1, 4, f);
+    fwrite(type, 1, 4, f);
+    if (!data.empty())
+        fwrite(data.data(), 1, data.size(), f);
+    uint32_t crc = crc32(0, (const uint8_t *)type, 4);
+    crc = crc32(crc, data.data(), data.size());
+    uint8_t c[4] = {(uint8_t)(crc >> 24), (uint8_t)(crc >> 16), (uint8_t)(crc >> 8), (uint8_t)crc};
+    fwrite(c, 1, 4, f);
+}
+
+bool writePng(const char *path, int w, int h, const std::vector<uint8_t> &px,
+              const uint32_t *palette, int paletteSize)
+{
+    TraceScope trace("writePng");
+    FILE *f = fopen(path, "wb");
+    if (!f)
+    {
+        logf("Cannot write %s", path);
+        return false;
+    }
+    static const uint8_t sig[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    fwrite(sig, 1, 8, f);
+
+    std::vector<uint8_t> ihdr = {(uint8_t)(w >> 24), (uint8_t)(w >> 16), (uint8_t)(w >> 8), (uint8_t)w,
+                                 (uint8_t)(h >> 24), (uint8_t)(h >> 16), (uint8_t)(h >> 8), (uint8_t)h,
+                                 8, 3, 0, 0, 0}; // 8-bit palette, no interlace
+    writeChunk(f, "IHDR", ihdr);
+    std::vector<uint8_t> plte;
+    for (int i = 0; i < paletteSize; ++i)
+        plte.insert(plte.end(), {(uint8_t)(palette[i] >> 16), (uint8_t)(palette[i] >> 8), (uint8_t)palette[i]});
+    writeChunk(f, "PLTE", plte);
+
+    // Scanlines with filter type 0 (none is recommended for palette images)
+    size_t stride = (size_t)w + 1;
+    std::vector<uint8_t> raw(stride * h);
+    for (int y = 0; y < h; ++y)
+    {
+        raw[y * stride] = 0;
+        memcpy(&raw[y * stride + 1], &px[(size_t)y * w], w);
+    }
+    writeChunk(f, "IDAT", zlibCompress(raw, stride));
+    writeChunk(f, "IEND", {});
+    return fclose(f) == 0;
+}
+
+// ---------- GIF ----------
+
+struct GifBits
+{
+    FILE *f;
+    uint8_t block[255];
+    int blockLen = 0;
+    uint32_t acc = 0;
+    int bits = 0;
+    void put(uint32_t code, int n)
+    {
+        acc |= code << bits;
+        bits += n;
+        while (bits >= 8)
+            byte((uint8_t)acc), acc >>= 8, bits -= 8;
+    }
+    void byte(uint8_t b)
+    {
+        block[blockLen++] = b;
+        if (blockLen == 255)
+            flushBlock();
+    }
+    void flushBlock()
+    {
+        if (!blockLen)
+            return;
+        fputc(blockLen, f);
+        fwrite(block, 1, blockLen, f);
+        blockLen = 0;
+    }
+    void finish()
+    {
+        if (bits)
+            byte((uint8_t)acc);
+        flushBlock();
+        fputc(0, f); // block terminator
+    }
+};
+
+bool GifWriter::open(const char *path, int width, int height, const uint32_t *palette, int paletteSize)
+{
+    f = fopen(path, "wb");
+    if (!f)
+    {
+        logf("Cannot write %s", path);
+        return false;
+    }
+    w = width;
+    h = height;
+    prev.clear();
+    depth = 2;
+    while ((1 << depth) < paletteSize && depth < 8)
+        ++depth;
+
+    fwrite("GIF89a", 1, 6, f);
+    uint8_t lsd[7] = {(uint8_t)w, (uint8_t)(w >> 8), (uint8_t)h, (uint8_t)(h >> 8),
+                      (uint8_t)(0xF0 | (depth - 1)), 0, 0}; // global color table
+    fwrite(lsd, 1, 7, f);
+    for (int i = 0; i < (1 << depth); ++i)
+    {
+        uint32_t c = i < paletteSize ? palette[i] : 0;
+        uint8_t rgb[3] = {(uint8_t)(c >> 16), (uint8_t)(c >> 8), (uint8_t)c};
+        fwrite(rgb, 1, 3, f);
+    }
+    static const uint8_t loop[19] = {0x21, 0xFF, 11, 'N', 'E', 'T', 'S', 'C', 'A', 'P', 'E',
+                                     '2', '.', '0', 3, 1, 0, 0, 0}; // loop forever
+    fwrite(loop, 1, 19, f);
+    return true;
+}
+
+void GifWriter::addFrame(const std::vector<uint8_t> &px, int delayCs)
+{
+    TraceScope trace("GifWriter::addFrame");
+    if (!f)
+        return;
+
+    // Only re-encode the rectangle that differs from the previous frame
+    int x0 = 0, y0 = 0, x1 = w - 1, y1 = h - 1;
+    if (!prev.empty())
+    {
+        x0 = w, y0 = h, x1 = -1, y1 = -1;
+        for (int y = 0; y < h; ++y)
+            for (int x = 0; x < w; ++x)
+                if (px[(size_t)y * w + x] != prev[(size_t)y * w + x])
+                {
+                    x0 = std::min(x0, x), x1 = std::max(x1, x);
+                    y0 = std::min(y0, y), y1 = std::max(y1, y);
+                }
+        if (x1 < 0) // unchanged: one pixel keeps the frame's delay
+            x0 = x1 = y0 = y1 = 0;
+    }
+    prev = px;
+
+    uint8_t gce[8] = {0x21, 0xF9, 4, 0x04, (uint8_t)delayCs, (uint8_t)(delayCs >> 8), 0, 0}; // keep previous
+    fwrite(gce, 1, 8, f);
+    int fw = x1 - x0 + 1, fh = y1 - y0 + 1;
+    uint8_t desc[10] = {0x2C, (uint8_t)x0, (uint8_t)(x0 >> 8), (uint8_t)y0, (uint8_t)(y0 >> 8),
+                        (uint8_t)fw, (uint8_t)(fw >> 8), (uint8_t)fh, (uint8_t)(fh >> 8), 0};
+    fwrite(desc, 1, 10, f);
+
+    // LZW with a (code, next symbol) -> code trie; reset when the table fills
+    const int clearCode = 1 << depth;
+    fputc(depth, f);
+    std::vector<uint16_t> trie((size_t)4096 << depth, 0);
+    GifBits out;
+    out.f = f;
+    int codeSize = depth + 1, maxCode = clearCode + 1, cur = -1;
+    out.put(clearCode, codeSize);
+    for (int y = y0; y <= y1; ++y)
+    {
+        for (int x = x0; x <= x1; ++x)
+        {
+            int sym = prev[(size_t)y * w + x];
+            if (cur < 0)
+            {
+                cur = sym;
+                continue;
+            }
+            uint16_t &nxt = trie[((size_t)cur << depth) + sym];
+            if (nxt)
+            {
+                cur = nxt;
+                continue;
+            }
+            out.put(cur, codeSize);
+            nxt = (uint16_t)++maxCode;
+            if (maxCode >= (1 << codeSize))
+                ++codeSize;
+            if (maxCode == 4095)
+            {
+                out.put(clearCode, codeSize);
+                std::fill(trie.begin(), trie.end(), 0);
+                codeSize = depth + 1;
+                maxCode = clearCode + 1;
+            }
+            cur = sym;
+        }
+    }
+    out.put(cur, codeSize);
+    // the decoder adds one more table entry on this last code and may widen
+    if (maxCode + 1 >= (1 << codeSize) && codeSize < 12)
+        ++codeSize;
+    out.put(clearCode, codeSize);
+    out.put(clearCode + 1, depth + 1);
+    out.finish();
+}
+
+bool GifWriter::close()
+{
+    if (!f)
+        return false;
+    fputc(0x3B, f);
+    bool ok = fclose(f) == 0;
+    f = nullptr;
+    return ok;
+}
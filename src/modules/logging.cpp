@@ -1,41 +1,264 @@
 #include "../headers/logging.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
-static std::ofstream gLog;
+// Bounded multi-producer queue (Vyukov): a slot is free for the producer whose
+// ticket equals its sequence number, readable once the sequence is ticket + 1.
+// Producers never block; when the writer falls behind, messages are dropped and
+// counted instead of stalling the caller.
+static const size_t ringSize = 1024; // power of two
+static const size_t msgSize = 512;   // longer messages are truncated
+
+struct LogSlot
+{
+    std::atomic<size_t> seq;
+    LogLevel level;
+    char text[msgSize];
+};
+
+static LogSlot ring[ringSize];
+static std::atomic<size_t> enqueuePos{0}, dequeuePos{0};
+static std::atomic<size_t> dropped{0};
+static std::atomic<int> minLevel{LL_DEBUG};
+
+static FILE *logFile = nullptr;
+static std::mutex writeMutex; // serialises the writer thread with fatal()/close_log()
+static std::mutex wakeMutex;
+static std::condition_variable wakeCv;
+static std::thread writer;
+static std::atomic<bool> stopping{false};
+static std::once_flag startOnce;
+
+static const char *levelPrefix[] = {"DEBUG: ", "", "WARN: ", "ERROR: "};
+
+static uint64_t nowMs()
+{
+    using namespace std::chrono;
+    return (uint64_t)duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// ---------- per-call-site rate limiting ----------
+
+// Call sites are identified by their format string literal. Each hashes to a
+// bucket allowing siteBudget messages per second; the rest are counted and
+// reported with the next message that gets through.
+static const int siteBuckets = 256;
+static const unsigned siteBudget = 20;
+
+struct SiteRate
+{
+    std::atomic<uint64_t> windowStart{0};
+    std::atomic<unsigned> count{0}, suppressed{0};
+};
+static SiteRate siteRates[siteBuckets];
+
+static bool allowSite(const char *fmt, unsigned &suppressedOut)
+{
+    SiteRate &r = siteRates[((uintptr_t)fmt >> 3) % siteBuckets];
+    uint64_t now = nowMs(), start = r.windowStart.load(std::memory_order_relaxed);
+    if (now - start >= 1000 && r.windowStart.compare_exchange_strong(start, now))
+    {
+        r.count = 0;
+        suppressedOut = r.suppressed.exchange(0);
+    }
+    if (r.count.fetch_add(1, std::memory_order_relaxed) < siteBudget)
+        return true;
+    r.suppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+// ---------- ring buffer ----------
+
+static void initRing()
+{
+    for (size_t i = 0; i < ringSize; ++i)
+        ring[i].seq.store(i, std::memory_order_relaxed);
+}
+
+// Safe from several consumers, so fatal() can drain alongside the writer thread
+static bool dequeueOne(LogLevel &level, char *out)
+{
+    size_t pos = dequeuePos.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        LogSlot &s = ring[pos & (ringSize - 1)];
+        size_t seq = s.seq.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (diff == 0)
+        {
+            if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                level = s.level;
+                memcpy(out, s.text, msgSize);
+                s.seq.store(pos + ringSize, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0)
+            return false; // empty
+        else
+            pos = dequeuePos.load(std::memory_order_relaxed);
+    }
+}
+
+static void writeLine(LogLevel level, const char *text)
+{
+    fprintf(stderr, "%s%s\n", levelPrefix[level], text);
+    if (logFile)
+        fprintf(logFile, "%s%s\n", levelPrefix[level], text);
+}
+
+// Drains everything queued; one flush per batch instead of one per message
+static void drain()
+{
+    std::lock_guard<std::mutex> lk(writeMutex);
+    LogLevel level;
+    char text[msgSize];
+    bool any = false;
+    while (dequeueOne(level, text))
+    {
+        writeLine(level, text);
+        any = true;
+    }
+    size_t lost = dropped.exchange(0);
+    if (lost)
+    {
+        snprintf(text, sizeof(text), "(log ring full, %zu messages dropped)", lost);
+        writeLine(LL_WARN, text);
+        any = true;
+    }
+    if (any && logFile)
+        fflush(logFile);
+}
+
+static void writerLoop()
+{
+    while (!stopping.load())
+    {
+        drain();
+        std::unique_lock<std::mutex> lk(wakeMutex);
+        wakeCv.wait_for(lk, std::chrono::milliseconds(100));
+    }
+    drain();
+}
+
+static void startWriter()
+{
+    std::call_once(startOnce, []
+                   {
+        initRing();
+        writer = std::thread(writerLoop);
+        atexit(close_log); });
+}
+
+static void enqueue(LogLevel level, const char *fmt, va_list ap)
+{
+    startWriter();
+    size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    LogSlot *s;
+    for (;;)
+    {
+        s = &ring[pos & (ringSize - 1)];
+        size_t seq = s->seq.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0)
+        {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed); // full
+            return;
+        }
+        else
+            pos = enqueuePos.load(std::memory_order_relaxed);
+    }
+    s->level = level;
+    vsnprintf(s->text, msgSize, fmt, ap);
+    s->seq.store(pos + 1, std::memory_order_release);
+    wakeCv.notify_one();
+}
+
+static void vlogAt(LogLevel level, const char *fmt, va_list ap)
+{
+    if (level < minLevel.load(std::memory_order_relaxed))
+        return;
+    unsigned suppressed = 0;
+    if (!allowSite(fmt, suppressed))
+        return;
+    if (suppressed)
+        logAt(level, "(%u similar messages suppressed)", suppressed);
+    if (stopping.load())
+    {
+        // writer already shut down (late messages during exit): write directly
+        char text[msgSize];
+        vsnprintf(text, sizeof(text), fmt, ap);
+        std::lock_guard<std::mutex> lk(writeMutex);
+        writeLine(level, text);
+        return;
+    }
+    enqueue(level, fmt, ap);
+}
+
+// ---------- public API ----------
 
 void open_log()
 {
-    gLog.open("maze_runner.log", std::ios::out | std::ios::trunc);
-    if (!gLog)
+    std::lock_guard<std::mutex> lk(writeMutex);
+    logFile = fopen("maze_runner.log", "w");
+    if (!logFile)
     {
         fprintf(stderr, "Failed to open maze_runner.log\n");
     }
     else
     {
         time_t t = time(nullptr);
-        gLog << "Maze Runner log started " << ctime(&t) << "\n";
-        gLog.flush();
+        fprintf(logFile, "Maze Runner log started %s\n", ctime(&t));
+        fflush(logFile);
     }
 }
 
+// Stops the writer after draining; registered with atexit, safe to call twice
+void close_log()
+{
+    if (writer.joinable())
+    {
+        stopping = true;
+        wakeCv.notify_one();
+        writer.join();
+    }
+    drain();
+    std::lock_guard<std::mutex> lk(writeMutex);
+    if (logFile)
+    {
+        fclose(logFile);
+        logFile = nullptr;
+    }
+}
+
+void setLogLevel(LogLevel level) { minLevel = level; }
+
+void logAt(LogLevel level, const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    vlogAt(level, fmt, ap);
+    va_end(ap);
+}
+
 void logf(const char *fmt, ...)
 {
     va_list ap;
     va_start(ap, fmt);
-    vfprintf(stderr, fmt, ap);
-    fprintf(stderr, "\n");
-    if (gLog)
-    {
-        char buf[4096];
-        va_list ap2;
-        va_copy(ap2, ap);
-        vsnprintf(buf, sizeof(buf), fmt, ap2);
-        va_end(ap2);
-        gLog << buf << "\n";
-        gLog.flush();
-    }
+    vlogAt(LL_INFO, fmt, ap);
     va_end(ap);
 }
 
+// Synchronous: everything queued so far is written and flushed before exiting
 [[noreturn]] void fatal(const char *fmt, ...)
 {
     va_list ap;
@@ -43,15 +266,19 @@ void logf(const char *fmt, ...)
     char buf[8192];
     vsnprintf(buf, sizeof(buf), fmt, ap);
     va_end(ap);
-    fprintf(stderr, "FATAL: %s\n", buf);
-    if (gLog)
+    drain();
     {
-        gLog << "FATAL: " << buf << "\n";
-        gLog.flush();
+        std::lock_guard<std::mutex> lk(writeMutex);
+        fprintf(stderr, "FATAL: %s\n", buf);
+        if (logFile)
+        {
+            fprintf(logFile, "FATAL: %s\n", buf);
+            fflush(logFile);
+        }
     }
 #ifdef _WIN32
     MessageBoxA(nullptr, buf, "Maze Runner fatal error", MB_OK | MB_ICONERROR);
     ShellExecuteA(nullptr, "open", "notepad.exe", "maze_runner.log", nullptr, SW_SHOWNORMAL);
 #endif
     std::exit(1);
-}
\ No newline at end of file
+}
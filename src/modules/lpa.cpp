@@ -0,0 +1,275 @@
+#include "../headers/lpa.h"
+#include "../headers/tracing.h"
+#include <chrono>
+
+static const float INF = std::numeric_limits<float>::infinity();
+static const int dirs[4][3] = {{0, -1, 0}, {1, 0, 1}, {0, 1, 2}, {-1, 0, 3}};
+
+// What a solve planned on, per cell: walls in bits 0-3, obstacle in bit 4
+struct Planned
+{
+    uint8_t flags;
+    float cost;
+};
+
+struct Key
+{
+    float k1, k2; // min(g, rhs) + h, then min(g, rhs)
+    int cell;
+    bool operator>(const Key &o) const { return k1 > o.k1 || (k1 == o.k1 && k2 > o.k2); }
+};
+
+static LpaInfo info;
+static std::vector<float> g, rhs;
+static std::vector<Planned> planned;
+static std::vector<Key> queue; // min-heap; entries go stale instead of being removed
+static std::vector<int> pending; // cells lpaCellChanged queued since the last solve
+static int planStart = -1, planEnd = -1, planCols = -1, planRows = -1;
+static unsigned int planRevision = ~0u;
+
+static double nowSeconds()
+{
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+static Planned plannedOf(int c)
+{
+    const Cell &cell = grid[c];
+    uint8_t f = cell.blocked << 4;
+    for (int d = 0; d < 4; ++d)
+        f |= cell.walls[d] << d;
+    return {f, cell.cost};
+}
+
+static float h(int c)
+{
+    return (float)(abs(c % gCols - planEnd % gCols) + abs(c / gCols - planEnd / gCols));
+}
+
+static Key keyOf(int c)
+{
+    float m = std::min(g[c], rhs[c]);
+    return {m + h(c), m, c};
+}
+
+static bool keyLess(const Key &a, const Key &b)
+{
+    return b > a;
+}
+
+// rhs from the neighbours that can step into c; queued while inconsistent
+static void updateCell(int c, SolveStats &stats)
+{
+    if (c != planStart)
+    {
+        float best = INF;
+        if (!grid[c].blocked)
+        {
+            int x = c % gCols, y = c / gCols;
+            for (auto &d : dirs)
+            {
+                int p = index(x + d[0], y + d[1]);
+                if (p >= 0 && g[p] < INF && !grid[p].walls[(d[2] + 2) % 4])
+                    best = std::min(best, g[p] + grid[c].cost);
+            }
+        }
+        rhs[c] = best;
+    }
+    if (g[c] != rhs[c])
+    {
+        queue.push_back(keyOf(c));
+        std::push_heap(queue.begin(), queue.end(), std::greater<Key>());
+        stats.edgesRelaxed++;
+        stats.peakFrontier = std::max(stats.peakFrontier, queue.size());
+    }
+}
+
+static void updateAround(int c, SolveStats &stats)
+{
+    updateCell(c, stats);
+    int x = c % gCols, y = c / gCols;
+    for (auto &d : dirs)
+    {
+        int v = index(x + d[0], y + d[1]);
+        if (v >= 0)
+            updateCell(v, stats);
+    }
+}
+
+// Neighbour p with the cheapest step into c, -1 when none reaches it
+static int bestPred(int c)
+{
+    int x = c % gCols, y = c / gCols, best = -1;
+    float bestCost = INF;
+    for (auto &d : dirs)
+    {
+        int p = index(x + d[0], y + d[1]);
+        if (p >= 0 && !grid[p].walls[(d[2] + 2) % 4] && g[p] + grid[c].cost < bestCost)
+        {
+            bestCost = g[p] + grid[c].cost;
+            best = p;
+        }
+    }
+    return best;
+}
+
+// An entry is stale once its cell is consistent or was queued again with
+// another key
+static bool stale(const Key &k)
+{
+    Key now = keyOf(k.cell);
+    return g[k.cell] == rhs[k.cell] || now.k1 != k.k1 || now.k2 != k.k2;
+}
+
+static void computeShortestPath(SolveStats &stats)
+{
+    for (;;)
+    {
+        while (!queue.empty() && stale(queue.front()))
+        {
+            std::pop_heap(queue.begin(), queue.end(), std::greater<Key>());
+            queue.pop_back();
+            stats.stalePops++;
+        }
+        if (queue.empty() || (!keyLess(queue.front(), keyOf(planEnd)) && rhs[planEnd] == g[planEnd]))
+            break;
+        int u = queue.front().cell;
+        std::pop_heap(queue.begin(), queue.end(), std::greater<Key>());
+        queue.pop_back();
+        stats.nodesExpanded++;
+        if (g[u] > rhs[u])
+        {
+            // Overconsistent: u settles at rhs and its successors may improve
+            g[u] = rhs[u];
+            int p = bestPred(u);
+            if (p >= 0)
+                pushEvent(p, u, false, grid[u].cost);
+        }
+        else
+        {
+            // Underconsistent: the path u had is gone; recompute it from scratch
+            g[u] = INF;
+            updateCell(u, stats);
+        }
+        int x = u % gCols, y = u / gCols;
+        for (auto &d : dirs)
+        {
+            int v = index(x + d[0], y + d[1]);
+            if (v >= 0 && !grid[u].walls[d[2]])
+                updateCell(v, stats);
+        }
+    }
+}
+
+static void startOver(SolveStats &stats)
+{
+    const int N = gCols * gRows;
+    g.assign(N, INF);
+    rhs.assign(N, INF);
+    planned.resize(N);
+    for (int c = 0; c < N; ++c)
+        planned[c] = plannedOf(c);
+    queue.clear();
+    planStart = startCell;
+    planEnd = endCell;
+    planCols = gCols;
+    planRows = gRows;
+    rhs[planStart] = 0.0f;
+    updateCell(planStart, stats);
+    info.fresh = true;
+}
+
+// Cells that differ from what the state was planned on, either queued by
+// lpaCellChanged or found by comparing the whole grid
+static bool collectChanges(std::vector<int> &changed)
+{
+    const int N = gCols * gRows;
+    if (planRevision == mazeRevision)
+    {
+        changed.swap(pending);
+        return true;
+    }
+    for (int c = 0; c < N; ++c)
+    {
+        Planned p = plannedOf(c);
+        if (p.flags != planned[c].flags || p.cost != planned[c].cost)
+        {
+            changed.push_back(c);
+            if ((int)changed.size() > N / 8)
+                return false;
+        }
+    }
+    return true;
+}
+
+SolveStats solveLPA()
+{
+    TraceScope trace("solveLPA");
+    SolveStats stats;
+    double t0 = nowSeconds();
+    const int N = gCols * gRows;
+    info = LpaInfo();
+    std::vector<int> changed;
+    if (planStart != startCell || planEnd != endCell || planCols != gCols || planRows != gRows ||
+        (int)g.size() != N || !collectChanges(changed))
+        startOver(stats);
+    else
+    {
+        for (int c : changed)
+        {
+            planned[c] = plannedOf(c);
+            updateAround(c, stats);
+        }
+        info.changedCells = (int)changed.size();
+    }
+    pending.clear();
+    planRevision = mazeRevision;
+    // Stale entries only leave from the top; drop them once they dominate
+    if (queue.size() > (size_t)N)
+    {
+        queue.erase(std::remove_if(queue.begin(), queue.end(), stale), queue.end());
+        std::make_heap(queue.begin(), queue.end(), std::greater<Key>());
+    }
+    computeShortestPath(stats);
+
+    // Back from the end along the cheapest steps; g is consistent along it
+    finalPathEdges.clear();
+    if (g[planEnd] < INF)
+        for (int c = planEnd, p; c != planStart && (p = bestPred(c)) >= 0 && (int)finalPathEdges.size() < N; c = p)
+            finalPathEdges.emplace_back(p, c);
+    std::reverse(finalPathEdges.begin(), finalPathEdges.end());
+    std::set<std::pair<int, int>> pathSet(finalPathEdges.begin(), finalPathEdges.end());
+    for (auto &e : events)
+        if (pathSet.count({std::get<0>(e), std::get<1>(e)}))
+            std::get<2>(e) = true;
+    stats.pathLength = finalPathEdges.size();
+    stats.scratchBytes = (size_t)N * (2 * sizeof(float) + sizeof(Planned)) + queue.capacity() * sizeof(Key);
+    stats.seconds = nowSeconds() - t0;
+    info.seconds = stats.seconds;
+    return stats;
+}
+
+void lpaCellChanged(int cell)
+{
+    // Only a state one edit behind is patched; anything else is compared in full
+    if (planRevision + 1 != mazeRevision || planCols != gCols || planRows != gRows || cell < 0 ||
+        cell >= gCols * gRows)
+        return;
+    pending.push_back(cell);
+    planRevision = mazeRevision;
+}
+
+const LpaInfo &lastLpa()
+{
+    return info;
+}
+
+void resetLpa()
+{
+    g.clear();
+    rhs.clear();
+    queue.clear();
+    pending.clear();
+    planStart = planEnd = planCols = planRows = -1;
+}
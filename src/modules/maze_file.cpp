@@ -0,0 +1,185 @@
+#include "../headers/maze_file.h"
+#include "../headers/contraction.h"
+#include "../headers/logging.h"
+#include "../headers/solvers.h"
+#include "../headers/tracing.h"
+
+static const char mazeMagic[4] = {'M', 'A', 'Z', 'E'};
+static const uint32_t mazeVersion = 1;
+static const char hierarchyTag[4] = {'C', 'H', 'I', 'X'};
+// Largest grid a file may claim, so a damaged header cannot ask for gigabytes
+static const long long maxCells = 1LL << 28;
+
+struct MazeHeader
+{
+    char magic[4];
+    uint32_t version;
+    int32_t cols, rows, start, end;
+};
+
+uint64_t mazeChecksum()
+{
+    uint64_t h = 1469598103934665603ULL;
+    auto mix = [&](const void *p, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+            h = (h ^ ((const uint8_t *)p)[i]) * 1099511628211ULL;
+    };
+    mix(&gCols, sizeof(gCols));
+    mix(&gRows, sizeof(gRows));
+    for (const Cell &c : grid)
+    {
+        mix(c.walls, sizeof(c.walls));
+        mix(&c.blocked, sizeof(c.blocked));
+        mix(&c.cost, sizeof(c.cost));
+    }
+    return h;
+}
+
+bool saveMaze(const char *path)
+{
+    TraceScope trace("saveMaze");
+    FILE *f = fopen(path, "wb");
+    if (!f)
+    {
+        logAt(LL_ERROR, "cannot write maze %s", path);
+        return false;
+    }
+    const int N = gCols * gRows;
+    MazeHeader head = {{}, mazeVersion, gCols, gRows, startCell, endCell};
+    memcpy(head.magic, mazeMagic, sizeof(mazeMagic));
+    std::vector<uint8_t> flags(N);
+    std::vector<float> costs(N);
+    for (int u = 0; u < N; ++u)
+    {
+        for (int d = 0; d < 4; ++d)
+            flags[u] |= grid[u].walls[d] << d;
+        flags[u] |= grid[u].blocked << 4;
+        costs[u] = grid[u].cost;
+    }
+    bool ok = fwrite(&head, sizeof(head), 1, f) == 1 && fwrite(flags.data(), 1, N, f) == (size_t)N &&
+              fwrite(costs.data(), sizeof(float), N, f) == (size_t)N;
+
+    // Section size is patched in once the payload is written
+    if (ok && contractionCurrent())
+    {
+        uint64_t size = 0, checksum = mazeChecksum();
+        ok = fwrite(hierarchyTag, sizeof(hierarchyTag), 1, f) == 1;
+        long sizeAt = ftell(f);
+        ok = ok && fwrite(&size, sizeof(size), 1, f) == 1 && fwrite(&checksum, sizeof(checksum), 1, f) == 1 &&
+             writeContraction(f);
+        long end = ftell(f);
+        size = (uint64_t)(end - sizeAt) - sizeof(size);
+        ok = ok && fseek(f, sizeAt, SEEK_SET) == 0 && fwrite(&size, sizeof(size), 1, f) == 1 &&
+             fseek(f, end, SEEK_SET) == 0;
+    }
+    ok = fclose(f) == 0 && ok;
+    if (!ok)
+        logAt(LL_ERROR, "error writing maze %s", path);
+    else
+        logf("Saved %dx%d maze to %s%s", gCols, gRows, path, contractionCurrent() ? " with its hierarchy" : "");
+    return ok;
+}
+
+static bool readSections(FILE *f, const char *path)
+{
+    char tag[4];
+    uint64_t size;
+    while (fread(tag, sizeof(tag), 1, f) == 1)
+    {
+        if (fread(&size, sizeof(size), 1, f) != 1)
+        {
+            logAt(LL_ERROR, "%s: truncated section header", path);
+            return false;
+        }
+        long next = ftell(f) + (long)size;
+        if (!memcmp(tag, hierarchyTag, sizeof(tag)))
+        {
+            uint64_t checksum;
+            if (fread(&checksum, sizeof(checksum), 1, f) != 1)
+                return false;
+            if (checksum != mazeChecksum())
+                logAt(LL_WARN, "%s: contraction hierarchy was built for another maze, ignored", path);
+            else
+                readContraction(f);
+        }
+        if (fseek(f, next, SEEK_SET) != 0)
+            return false;
+    }
+    return true;
+}
+
+// The grid is only replaced once the header and every cell have been read
+bool loadMaze(const char *path)
+{
+    TraceScope trace("loadMaze");
+    FILE *f = fopen(path, "rb");
+    if (!f)
+    {
+        logAt(LL_ERROR, "cannot read maze %s", path);
+        return false;
+    }
+    MazeHeader head;
+    bool ok = fread(&head, sizeof(head), 1, f) == 1 && !memcmp(head.magic, mazeMagic, sizeof(mazeMagic));
+    long long cells = ok ? (long long)head.cols * head.rows : 0;
+    ok = ok && head.version == mazeVersion && head.cols >= 2 && head.rows >= 2 && cells <= maxCells &&
+         head.start >= 0 && head.start < cells && head.end >= 0 && head.end < cells;
+    if (!ok)
+    {
+        logAt(LL_ERROR, "%s is not a version %u maze file", path, mazeVersion);
+        fclose(f);
+        return false;
+    }
+    std::vector<uint8_t> flags(cells);
+    std::vector<float> costs(cells);
+    ok = fread(flags.data(), 1, cells, f) == (size_t)cells &&
+         fread(costs.data(), sizeof(float), cells, f) == (size_t)cells;
+    for (long long u = 0; u < cells && ok; ++u)
+        ok = costs[u] >= 1.0f && costs[u] < std::numeric_limits<float>::infinity();
+    if (!ok)
+    {
+        logAt(LL_ERROR, "%s: truncated or bad cell data", path);
+        fclose(f);
+        return false;
+    }
+
+    resetAnimationBuffers();
+    gCols = head.cols;
+    gRows = head.rows;
+    grid.assign(cells, Cell());
+    for (long long u = 0; u < cells; ++u)
+    {
+        for (int d = 0; d < 4; ++d)
+            grid[u].walls[d] = (flags[u] >> d) & 1;
+        grid[u].blocked = (flags[u] >> 4) & 1;
+        grid[u].cost = costs[u];
+    }
+    // A wall on one side only would let solvers cross one way and the region
+    // labels and indexes, which read both sides, disagree with them; close it
+    int oneSided = 0;
+    for (int u = 0; u < cells; ++u)
+    {
+        int x = u % gCols;
+        if (x + 1 < gCols && grid[u].walls[1] != grid[u + 1].walls[3])
+        {
+            grid[u].walls[1] = grid[u + 1].walls[3] = true;
+            oneSided++;
+        }
+        if (u + gCols < cells && grid[u].walls[2] != grid[u + gCols].walls[0])
+        {
+            grid[u].walls[2] = grid[u + gCols].walls[0] = true;
+            oneSided++;
+        }
+    }
+    if (oneSided)
+        logAt(LL_WARN, "%s: closed %d walls set on one side only", path, oneSided);
+    startCell = head.start;
+    endCell = head.end;
+    mazeRevision++;
+
+    if (!readSections(f, path))
+        logAt(LL_WARN, "%s: damaged section, kept the maze only", path);
+    fclose(f);
+    logf("Loaded %dx%d maze from %s%s", gCols, gRows, path, contractionCurrent() ? " with its hierarchy" : "");
+    return true;
+}
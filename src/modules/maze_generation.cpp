@@ -1,5 +1,11 @@
 #include "../headers/maze_generation.h"
+#include "../headers/components.h"
+#include "../headers/dead_ends.h"
+#include "../headers/hpa.h"
+#include "../headers/lpa.h"
 #include "../headers/logging.h"
+#include "../headers/parallel_bfs.h"
+#include "../headers/tracing.h"
 #include "../headers/solvers.h"
 #include "../headers/rendering.h"
 #include "../headers/solvers.h"
@@ -40,7 +46,7 @@ std::vector<int> getUnvisitedNeighbors(int x, int y)
     {
         int ni = index(x + d[0], y + d[1]);
         if (ni != -1 && !grid[ni].visited)
-            nbrs.push_back((d[2] << 16) | ni);
+            nbrs.push_back(ni * 4 + d[2]); // cell index and wall direction
     }
     return nbrs;
 }
@@ -60,6 +66,7 @@ void clearGridVisited()
 // Ensure start/end points have multiple pathways (at least 7 as requested)
 void ensureMultiplePathways()
 {
+    TraceScope trace("ensureMultiplePathways");
     auto createPathwaysAroundCell = [&](int cellIdx, int minPathways) {
         int x = cellIdx % gCols, y = cellIdx / gCols;
         std::vector<std::pair<int, int>> neighbors;
@@ -122,6 +129,7 @@ void ensureMultiplePathways()
 // Add some strategic complexity while maintaining maze structure
 void addMazeComplexity()
 {
+    TraceScope trace("addMazeComplexity");
     // Add a few strategic loops to make the maze more interesting
     int loopCount = std::max(2, (gCols * gRows) / 50);
     std::uniform_int_distribution<int> cellDist(0, gCols * gRows - 1);
@@ -164,6 +172,7 @@ void addMazeComplexity()
 
 void generateBacktracker()
 {
+    TraceScope trace("generateBacktracker");
     // Initialize grid with all walls up (proper maze start)
     grid.assign(gCols * gRows, Cell());
     
@@ -185,7 +194,7 @@ void generateBacktracker()
         {
             std::uniform_int_distribution<int> di(0, (int)nbrs.size() - 1);
             int packed = nbrs[di(rng)];
-            int w = packed >> 16, nxt = packed & 0xFFFF;
+            int w = packed & 3, nxt = packed >> 2;
             
             st.push(current);
             removeWallsAB(current, nxt, w);
@@ -214,13 +223,17 @@ void generateBacktracker()
     
     clearGridVisited();
     
-    // Add strategic complexity and ensure pathways
-    addMazeComplexity();
-    ensureMultiplePathways();
+    // Add strategic complexity and ensure pathways; a perfect maze stays a spanning tree
+    if (!perfectMazes)
+    {
+        addMazeComplexity();
+        ensureMultiplePathways();
+    }
 }
 
 void generatePrim()
 {
+    TraceScope trace("generatePrim");
     // Initialize all walls up
     grid.assign(gCols * gRows, Cell());
     
@@ -266,13 +279,17 @@ void generatePrim()
     
     clearGridVisited();
     
-    // Add strategic complexity and ensure pathways
-    addMazeComplexity();
-    ensureMultiplePathways();
+    // Add strategic complexity and ensure pathways; a perfect maze stays a spanning tree
+    if (!perfectMazes)
+    {
+        addMazeComplexity();
+        ensureMultiplePathways();
+    }
 }
 
 void generateKruskal()
 {
+    TraceScope trace("generateKruskal");
     // Initialize all walls up
     grid.assign(gCols * gRows, Cell());
     int N = gCols * gRows;
@@ -311,9 +328,12 @@ void generateKruskal()
     
     clearGridVisited();
     
-    // Add strategic complexity and ensure pathways
-    addMazeComplexity();
-    ensureMultiplePathways();
+    // Add strategic complexity and ensure pathways; a perfect maze stays a spanning tree
+    if (!perfectMazes)
+    {
+        addMazeComplexity();
+        ensureMultiplePathways();
+    }
 }
 
 void pickStartEnd()
@@ -344,6 +364,8 @@ void pickStartEnd()
     if (grid[startCell].blocked) grid[startCell].blocked = false;
     if (grid[endCell].blocked) grid[endCell].blocked = false;
     
+    mazeRevision++;
+
     logf("Start: (%d,%d), End: (%d,%d)", 
          startCell % gCols, startCell / gCols,
          endCell % gCols, endCell / gCols);
@@ -351,144 +373,148 @@ void pickStartEnd()
 
 void randomizeObstacles(float density)
 {
+    TraceScope trace("randomizeObstacles");
     // Clear all obstacles first
     for (auto &c : grid)
         c.blocked = false;
-    
-    // Find ALL possible paths from start to end using BFS with path tracking
-    std::vector<std::vector<int>> allPaths;
-    std::function<void(int, std::vector<int>&, std::vector<bool>&)> findAllPaths = 
-        [&](int current, std::vector<int>& currentPath, std::vector<bool>& visited) 
-    {
-        if (current == endCell) 
-        {
-            allPaths.push_back(currentPath);
-            return;
-        }
-        
-        int x = current % gCols, y = current / gCols;
-        static const int dirs[4][3] = {{0, -1, 0}, {1, 0, 1}, {0, 1, 2}, {-1, 0, 3}};
-        
-        for (auto &d : dirs) 
-        {
-            int nx = x + d[0], ny = y + d[1];
-            int next = index(nx, ny);
-            if (next >= 0 && !grid[current].walls[d[2]] && !visited[next]) 
-            {
-                visited[next] = true;
-                currentPath.push_back(next);
-                findAllPaths(next, currentPath, visited);
-                currentPath.pop_back();
-                visited[next] = false;
-            }
-        }
-    };
-    
-    std::vector<bool> visited(gCols * gRows, false);
-    std::vector<int> currentPath;
-    visited[startCell] = true;
-    currentPath.push_back(startCell);
-    findAllPaths(startCell, currentPath, visited);
-    
-    if (allPaths.empty()) 
+    mazeRevision++;
+
+    // Region labels answer "no path" without enumerating anything
+    if (!cellsConnected(startCell, endCell))
     {
         logf("No paths found between start and end!");
         return;
     }
-    
-    logf("Found %d different paths from start to end", (int)allPaths.size());
-    
+
     // Strategy: Either block ALL paths or NO paths (user's requirement)
     std::uniform_real_distribution<float> choice(0.0f, 1.0f);
     bool blockAllPaths = choice(rng) < 0.3f; // 30% chance to block all paths
-    
+    const DeadEndFill &fill = currentDeadEndFill();
+
     if (blockAllPaths)
     {
-        // Block ALL paths - place obstacles on critical choke points
-        std::set<int> criticalCells;
-        
-        // Find cells that appear in ALL paths (choke points)
-        if (!allPaths.empty())
-        {
-            std::map<int, int> cellFrequency;
-            for (const auto& path : allPaths)
-            {
-                for (int cell : path)
-                {
-                    if (cell != startCell && cell != endCell)
-                        cellFrequency[cell]++;
-                }
-            }
-            
-            // Cells that appear in many paths are critical
-            int pathCount = allPaths.size();
-            for (const auto& pair : cellFrequency)
-            {
-                if (pair.second >= pathCount * 0.7f) // In at least 70% of paths
-                {
-                    criticalCells.insert(pair.first);
-                }
-            }
-        }
-        
-        // Place obstacles on some critical cells
-        std::vector<int> criticalList(criticalCells.begin(), criticalCells.end());
-        if (!criticalList.empty())
-        {
-            std::shuffle(criticalList.begin(), criticalList.end(), rng);
-            int obstacleCount = std::min((int)(criticalList.size() * 0.6f), (int)(criticalList.size()));
-            
-            for (int i = 0; i < obstacleCount; i++)
-            {
-                grid[criticalList[i]].blocked = true;
-            }
-            
-            logf("Blocked ALL paths by placing %d strategic obstacles", obstacleCount);
-        }
+        // Every path from the start climbs the BFS distances one step at a time,
+        // so each layer strictly between start and end is a cut. Block the one
+        // with the fewest cells that some simple path can still use.
+        BfsField flood;
+        bfsFieldParallel(startCell, flood);
+        int endDist = flood.dist[endCell];
+        std::vector<int> layerSize(std::max(endDist, 1), 0);
+        for (int i = 0; i < gCols * gRows; i++)
+            if (flood.dist[i] > 0 && flood.dist[i] < endDist && !fill.sealed[i])
+                layerSize[flood.dist[i]]++;
+        int best = -1;
+        for (int k = 1; k < endDist; k++)
+            if (best < 0 || layerSize[k] < layerSize[best])
+                best = k;
+
+        // Sealed cells of the layer go last: they only matter if the fill and
+        // the solvers disagree about a wall. Each block updates the labels in
+        // place, so the loop stops as soon as start and end are apart.
+        std::vector<int> layer;
+        for (int i = 0; best > 0 && i < gCols * gRows; i++)
+            if (flood.dist[i] == best)
+                layer.push_back(i);
+        std::stable_partition(layer.begin(), layer.end(), [&](int c)
+                              { return !fill.sealed[c]; });
+        int obstacleCount = 0;
+        while (obstacleCount < (int)layer.size() && cellsConnected(startCell, endCell))
+            setCellBlocked(layer[obstacleCount++], true);
+        bool cut = !cellsConnected(startCell, endCell);
+        logf("Blocked ALL paths by placing %d strategic obstacles%s", obstacleCount,
+             cut ? "" : " (a path remains)");
     }
     else
     {
-        // Don't block ANY path - place obstacles only in areas that don't affect any path
-        std::set<int> pathCells;
-        for (const auto& path : allPaths)
-        {
-            for (int cell : path)
-                pathCells.insert(cell);
-        }
-        
-        // Place obstacles randomly on non-path cells
+        // Don't block ANY path - sealed cells are on no simple start-end path
         std::vector<int> safeCells;
         for (int i = 0; i < gCols * gRows; i++)
         {
-            if (pathCells.find(i) == pathCells.end() && i != startCell && i != endCell)
-            {
+            if (fill.sealed[i] && i != startCell && i != endCell)
                 safeCells.push_back(i);
-            }
         }
-        
+
         if (!safeCells.empty())
         {
             std::shuffle(safeCells.begin(), safeCells.end(), rng);
             int obstacleCount = std::min((int)(safeCells.size() * density), (int)safeCells.size());
-            
+
             for (int i = 0; i < obstacleCount; i++)
             {
                 grid[safeCells[i]].blocked = true;
             }
-            
-            logf("Preserved all %d paths, placed %d obstacles in safe areas", (int)allPaths.size(), obstacleCount);
+            mazeRevision++;
+
+            // One label rebuild, which the next solve's reachability check reuses
+            if (!cellsConnected(startCell, endCell))
+                logAt(LL_WARN, "obstacles cut the start from the end despite avoiding every path");
+            logf("Preserved all paths through %d cells, placed %d obstacles in safe areas",
+                 fill.viableCells, obstacleCount);
         }
     }
 }
 
+// Single-cell obstacle edit that keeps the region labels current
+void setCellBlocked(int cell, bool blocked)
+{
+    if (cell < 0 || cell >= gCols * gRows || grid[cell].blocked == blocked)
+        return;
+    grid[cell].blocked = blocked;
+    mazeRevision++;
+    componentsCellChanged(cell);
+    hpaCellChanged(cell);
+    lpaCellChanged(cell);
+}
+
 void clearObstacles()
 {
     for (auto &c : grid)
         c.blocked = false;
+    mazeRevision++;
+}
+
+// Smooth random terrain: value noise on a 16-cell lattice, smoothstep-blended.
+// Costs are whole numbers in [1, maxCost] so path sums stay exact in float.
+void randomizeTerrain(float maxCost)
+{
+    TraceScope trace("randomizeTerrain");
+    const int cellSpan = 16;
+    int lw = gCols / cellSpan + 2, lh = gRows / cellSpan + 2;
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<float> lattice(lw * lh);
+    for (float &v : lattice)
+        v = unit(rng);
+    auto smooth = [](float t)
+    { return t * t * (3.0f - 2.0f * t); };
+    float span = std::max(0.0f, maxCost - 1.0f);
+    for (int y = 0; y < gRows; y++)
+    {
+        int ly = y / cellSpan;
+        float ty = smooth((y % cellSpan + 0.5f) / cellSpan);
+        for (int x = 0; x < gCols; x++)
+        {
+            int lx = x / cellSpan;
+            float tx = smooth((x % cellSpan + 0.5f) / cellSpan);
+            const float *r0 = &lattice[ly * lw + lx], *r1 = r0 + lw;
+            float top = r0[0] + (r0[1] - r0[0]) * tx;
+            float bottom = r1[0] + (r1[1] - r1[0]) * tx;
+            float n = top + (bottom - top) * ty;
+            grid[y * gCols + x].cost = 1.0f + std::round(span * n * n); // squared: mostly cheap, a few ridges
+        }
+    }
+    mazeRevision++;
+}
+
+void clearTerrain()
+{
+    for (auto &c : grid)
+        c.cost = 1.0f;
+    mazeRevision++;
 }
 
 void regenerateMaze()
 {
+    TraceScope trace("regenerateMaze");
     resetAnimationBuffers();
     if (genAlgo == 0)
         generateBacktracker();
@@ -497,5 +523,5 @@ void regenerateMaze()
     else
         generateKruskal();
     pickStartEnd();
-    buildWallVertices();
+    mazeRevision++;
 }
\ No newline at end of file
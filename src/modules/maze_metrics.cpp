@@ -0,0 +1,163 @@
+#include "../headers/maze_metrics.h"
+#include "../headers/parallel.h"
+#include "../headers/parallel_bfs.h"
+#include "../headers/tracing.h"
+#include <chrono>
+
+static const int popBits[16] = {0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4};
+
+// Open-direction masks (bit d: direction d, top/right/bottom/left, leads to an
+// open cell), built once per call so the corridor walks and degree sums read one
+// byte per cell instead of the neighbouring Cells
+static std::vector<uint8_t> masks;
+
+// Branch-free: the walls of a random maze are unpredictable, so the guarded
+// version spends most of its time in mispredicts
+static int buildMasks(int y0, int y1)
+{
+    const int C = gCols;
+    int open = 0;
+    for (int y = y0; y < y1; ++y)
+    {
+        const Cell *row = &grid[(size_t)y * C];
+        const Cell *up = y > 0 ? row - C : row;
+        const Cell *down = y + 1 < gRows ? row + C : row;
+        int hasUp = y > 0, hasDown = y + 1 < gRows;
+        uint8_t *out = &masks[(size_t)y * C];
+        for (int x = 0; x < C; ++x)
+        {
+            const Cell &c = row[x];
+            int l = x > 0 ? x - 1 : x, r = x + 1 < C ? x + 1 : x;
+            int walls = c.walls[0] | c.walls[1] << 1 | c.walls[2] << 2 | c.walls[3] << 3;
+            int free = (hasUp & (up[x].blocked ^ 1)) |
+                       (((x + 1 < C) & (row[r].blocked ^ 1)) << 1) |
+                       ((hasDown & (down[x].blocked ^ 1)) << 2) |
+                       (((x > 0) & (row[l].blocked ^ 1)) << 3);
+            int m = free & ~walls;
+            out[x] = c.blocked ? 0 : (uint8_t)m;
+            open += !c.blocked;
+        }
+    }
+    return open;
+}
+
+// For a degree-2 mask entered moving in direction `in`: the direction it leaves
+// by. Other masks map to -1, which ends the walk.
+static int exitDir[16][4];
+static void initExitDir()
+{
+    for (int m = 0; m < 16; ++m)
+        for (int in = 0; in < 4; ++in)
+        {
+            int rest = m & ~(1 << ((in + 2) & 3));
+            exitDir[m][in] = -1;
+            if (popBits[m] == 2 && rest != m)
+                exitDir[m][in] = rest & 1 ? 0 : rest & 2 ? 1 : rest & 4 ? 2 : 3;
+        }
+}
+
+// Per-band partial sums, merged after the parallel pass
+struct BandMetrics
+{
+    int openCells = 0;
+    int degreeCount[5] = {};
+    long long degreeSum = 0, corridorSum = 0;
+    int corridors = 0, longestCorridor = 0;
+    int corridorHist[METRIC_HIST_BUCKETS] = {};
+};
+
+// Every corridor touches two endpoints; it is walked from both and kept by the
+// smaller endpoint (or, for a loop back to the same cell, the smaller exit direction)
+static void scanBand(int y0, int y1, BandMetrics &b)
+{
+    const int off[4] = {-gCols, 1, gCols, -1};
+    const uint8_t *mask = masks.data();
+    for (int u = y0 * gCols; u < y1 * gCols; ++u)
+    {
+        int m = mask[u], deg = popBits[m];
+        b.degreeCount[deg]++;
+        b.degreeSum += deg;
+        if (deg == 0 || deg == 2)
+            continue;
+        for (int bits = m; bits; bits &= bits - 1)
+        {
+            int d = bits & 1 ? 0 : bits & 2 ? 1 : bits & 4 ? 2 : 3;
+            int v = u + off[d], dir = d, len = 1;
+            for (int next; (next = exitDir[mask[v]][dir]) >= 0; len++)
+            {
+                dir = next;
+                v += off[dir];
+            }
+            if (v < u || (v == u && ((dir + 2) & 3) < d))
+                continue;
+            b.corridors++;
+            b.corridorSum += len;
+            b.longestCorridor = std::max(b.longestCorridor, len);
+            int bucket = 0;
+            while ((2 << bucket) <= len && bucket + 1 < METRIC_HIST_BUCKETS)
+                bucket++;
+            b.corridorHist[bucket]++;
+        }
+    }
+}
+
+MazeMetrics computeMazeMetrics(bool withDistances)
+{
+    TraceScope trace("computeMazeMetrics");
+    using namespace std::chrono;
+    auto t0 = steady_clock::now();
+    MazeMetrics mm;
+    int N = gCols * gRows;
+    if (N <= 0 || (int)grid.size() != N)
+        return mm;
+
+    // Corridors cross band borders, so all masks exist before any band walks them
+    static bool tablesReady = (initExitDir(), true);
+    (void)tablesReady;
+    int bands = std::min(gRows, workerCount() * 4);
+    std::vector<BandMetrics> parts(bands);
+    masks.resize(N);
+    parallelFor(bands, [&](int i)
+                { parts[i].openCells = buildMasks(gRows * i / bands, gRows * (i + 1) / bands); });
+    parallelFor(bands, [&](int i)
+                { scanBand(gRows * i / bands, gRows * (i + 1) / bands, parts[i]); });
+
+    long long degreeSum = 0, corridorSum = 0;
+    for (const BandMetrics &b : parts)
+    {
+        mm.openCells += b.openCells;
+        for (int k = 0; k < 5; ++k)
+            mm.degreeCount[k] += b.degreeCount[k];
+        for (int k = 0; k < METRIC_HIST_BUCKETS; ++k)
+            mm.corridorHist[k] += b.corridorHist[k];
+        degreeSum += b.degreeSum;
+        corridorSum += b.corridorSum;
+        mm.corridors += b.corridors;
+        mm.longestCorridor = std::max(mm.longestCorridor, b.longestCorridor);
+    }
+    mm.edges = degreeSum / 2;
+    mm.deadEnds = mm.degreeCount[1];
+    mm.junctions = mm.degreeCount[3] + mm.degreeCount[4];
+    mm.meanCorridor = mm.corridors ? (double)corridorSum / mm.corridors : 0.0;
+
+    if (withDistances && startCell >= 0 && startCell < N && !grid[startCell].blocked)
+    {
+        static BfsField field; // reused so repeated calls keep their allocations
+        bfsFieldParallel(startCell, field);
+        std::vector<long long> degreeParts(bands, 0);
+        parallelFor(bands, [&](int i)
+                    {
+            for (int u = (int)((long long)N * i / bands); u < (int)((long long)N * (i + 1) / bands); ++u)
+                if (field.dist[u] >= 0)
+                    degreeParts[i] += popBits[masks[u]]; });
+        long long reachDegree = 0;
+        for (long long d : degreeParts)
+            reachDegree += d;
+        mm.reachable = (int)field.reached;
+        mm.loops = reachDegree / 2 - (mm.reachable - 1);
+        mm.startEccentricity = field.levels - 1;
+        mm.endDistance = endCell >= 0 && endCell < N ? field.dist[endCell] : -1;
+    }
+    mm.seconds = duration<double>(steady_clock::now() - t0).count();
+    return mm;
+}
@@ -0,0 +1,96 @@
+#include "../headers/parallel.h"
+#include "../headers/tracing.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// One job at a time: workers and the caller pull indices from `next` until
+// `count` is exhausted. Nested calls from inside a job run inline. Every worker
+// acknowledges every job, even one it wakes too late to help with, and the
+// caller returns only once all have: until then no job state is reused.
+// The sync objects are never destroyed: detached workers are still blocked on
+// wakeCv at exit, and destroying a waited-on condition variable can hang
+static std::mutex &poolMutex = *new std::mutex, &jobMutex = *new std::mutex;
+static std::condition_variable &wakeCv = *new std::condition_variable, &doneCv = *new std::condition_variable;
+static bool workersStarted = false;
+static const std::function<void(int)> *jobFn = nullptr;
+static std::atomic<int> next{0};
+static int jobCount = 0, acked = 0;
+static unsigned jobSerial = 0;
+static thread_local bool inJob = false;
+
+static void runIndices(const std::function<void(int)> &fn, int count)
+{
+    TraceScope trace("parallelFor");
+    inJob = true;
+    for (int i = next++; i < count; i = next++)
+        fn(i);
+    inJob = false;
+}
+
+static void workerLoop()
+{
+    traceThreadName("worker");
+    unsigned seen = 0;
+    for (;;)
+    {
+        const std::function<void(int)> *fn;
+        int count;
+        {
+            std::unique_lock<std::mutex> lk(poolMutex);
+            wakeCv.wait(lk, [&]
+                        { return jobSerial != seen; });
+            seen = jobSerial;
+            fn = jobFn;
+            count = jobCount;
+        }
+        runIndices(*fn, count);
+        {
+            std::lock_guard<std::mutex> lk(poolMutex);
+            if (++acked == workerCount() - 1)
+                doneCv.notify_all();
+        }
+    }
+}
+
+int workerCount()
+{
+    static int n = std::max(1u, std::thread::hardware_concurrency());
+    return n;
+}
+
+void parallelFor(int count, const std::function<void(int)> &fn)
+{
+    if (count <= 0)
+        return;
+    if (count == 1 || workerCount() == 1 || inJob)
+    {
+        for (int i = 0; i < count; ++i)
+            fn(i);
+        return;
+    }
+
+    std::lock_guard<std::mutex> job(jobMutex); // serialise callers from different threads
+    {
+        std::lock_guard<std::mutex> lk(poolMutex);
+        if (!workersStarted)
+        {
+            // workers live for the whole process; they only ever block on wakeCv
+            for (int i = 1; i < workerCount(); ++i)
+                std::thread(workerLoop).detach();
+            workersStarted = true;
+        }
+        jobFn = &fn;
+        jobCount = count;
+        next = 0;
+        acked = 0;
+        jobSerial++;
+    }
+    wakeCv.notify_all();
+    runIndices(fn, count);
+
+    std::unique_lock<std::mutex> lk(poolMutex);
+    doneCv.wait(lk, []
+                { return acked == workerCount() - 1; });
+}
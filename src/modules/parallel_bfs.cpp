@@ -0,0 +1,204 @@
+#include "../headers/parallel_bfs.h"
+#include "../headers/parallel.h"
+#include "../headers/tracing.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+static const int dirs[4][3] = {{0, -1, 0}, {1, 0, 1}, {0, 1, 2}, {-1, 0, 3}};
+static const uint32_t noRank = UINT32_MAX;
+
+// Beamer's switch points, with cells standing in for edges (grid degree <= 4)
+static const size_t bottomUpWhenFrontierTimes = 14; // frontier * 14 > unvisited
+static const size_t topDownWhenFrontierTimes = 24;  // frontier * 24 < all cells
+
+static double nowSeconds()
+{
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+static void resetField(BfsField &out, int N)
+{
+    out.dist.assign(N, -1);
+    out.parent.assign(N, -1);
+    out.levels = 0;
+    out.reached = 0;
+    out.bottomUpLevels = 0;
+}
+
+void bfsFieldSequential(int source, BfsField &out)
+{
+    TraceScope trace("bfsFieldSequential");
+    double t0 = nowSeconds();
+    int N = gCols * gRows;
+    resetField(out, N);
+    if (source < 0 || source >= N)
+        return;
+    std::vector<int> queue;
+    queue.reserve(N);
+    queue.push_back(source);
+    out.dist[source] = 0;
+    for (size_t qi = 0; qi < queue.size(); ++qi)
+    {
+        int u = queue[qi], x = u % gCols, y = u / gCols;
+        for (auto &d : dirs)
+        {
+            int v = index(x + d[0], y + d[1]);
+            if (v < 0 || grid[u].walls[d[2]] || grid[v].blocked || out.dist[v] >= 0)
+                continue;
+            out.dist[v] = out.dist[u] + 1;
+            out.parent[v] = u;
+            queue.push_back(v);
+        }
+    }
+    out.reached = queue.size();
+    out.levels = out.dist[queue.back()] + 1;
+    out.seconds = nowSeconds() - t0;
+}
+
+// Chunks of at least `grain` items, a few per worker for balance
+static int partsFor(size_t items, size_t grain)
+{
+    return (int)std::max<size_t>(1, std::min<size_t>(workerCount() * 4, (items + grain - 1) / grain));
+}
+
+// Each level runs in two parallel phases over the ordered frontier:
+//  1. discovery: every unvisited cell reachable from the frontier gets
+//     rank = 4 * (frontier position of its first parent) + direction, the
+//     smallest such key being the edge the queue BFS takes. Top-down does an
+//     atomic min per edge; bottom-up lets each unvisited cell scan its own
+//     neighbours for frontier cells (dist == level) without atomics.
+//  2. claim: walking the frontier again, the edge whose key matches owns the
+//     cell and appends it to its chunk's buffer, so concatenating the buffers
+//     in chunk order reproduces the queue order of the next level.
+// Once a cell is in the frontier its rank is overwritten with its position.
+void bfsFieldParallel(int source, BfsField &out)
+{
+    TraceScope trace("bfsFieldParallel");
+    double t0 = nowSeconds();
+    int N = gCols * gRows;
+    resetField(out, N);
+    if (source < 0 || source >= N)
+        return;
+
+    size_t words = ((size_t)N + 63) / 64;
+    std::unique_ptr<std::atomic<uint64_t>[]> visited(new std::atomic<uint64_t>[words]);
+    std::unique_ptr<std::atomic<uint32_t>[]> rank(new std::atomic<uint32_t>[N]);
+    int initParts = partsFor(N, 1 << 16);
+    parallelFor(initParts, [&](int p)
+                {
+        size_t lo = (size_t)N * p / initParts, hi = (size_t)N * (p + 1) / initParts;
+        for (size_t i = lo; i < hi; ++i)
+            rank[i].store(noRank, std::memory_order_relaxed);
+        for (size_t w = words * p / initParts; w < words * (p + 1) / initParts; ++w)
+            visited[w].store(0, std::memory_order_relaxed); });
+    auto isVisited = [&](int v)
+    { return (visited[v >> 6].load(std::memory_order_relaxed) >> (v & 63)) & 1; };
+    auto markVisited = [&](int v)
+    { visited[v >> 6].fetch_or(uint64_t(1) << (v & 63), std::memory_order_relaxed); };
+
+    std::vector<int> frontier{source}, next;
+    std::vector<std::vector<int>> local(workerCount() * 4);
+    std::vector<size_t> offset(local.size() + 1);
+    markVisited(source);
+    rank[source].store(0);
+    out.dist[source] = 0;
+    size_t unvisited = N - 1;
+    bool bottomUp = false;
+
+    for (int level = 0; !frontier.empty(); ++level)
+    {
+        if (!bottomUp && frontier.size() * bottomUpWhenFrontierTimes > unvisited)
+            bottomUp = true;
+        else if (bottomUp && frontier.size() * topDownWhenFrontierTimes < (size_t)N)
+            bottomUp = false;
+
+        int parts = partsFor(frontier.size(), 2048);
+        if (!bottomUp)
+        {
+            parallelFor(parts, [&](int p)
+                        {
+                size_t lo = frontier.size() * p / parts, hi = frontier.size() * (p + 1) / parts;
+                for (size_t i = lo; i < hi; ++i)
+                {
+                    int u = frontier[i], x = u % gCols, y = u / gCols;
+                    for (int d = 0; d < 4; ++d)
+                    {
+                        int v = index(x + dirs[d][0], y + dirs[d][1]);
+                        if (v < 0 || grid[u].walls[d] || grid[v].blocked || isVisited(v))
+                            continue;
+                        uint32_t key = (uint32_t)(i * 4 + d), cur = rank[v].load(std::memory_order_relaxed);
+                        while (key < cur && !rank[v].compare_exchange_weak(cur, key, std::memory_order_relaxed))
+                            ;
+                    }
+                } });
+        }
+        else
+        {
+            out.bottomUpLevels++;
+            int wparts = partsFor(words, 1024);
+            parallelFor(wparts, [&](int p)
+                        {
+                for (size_t w = words * p / wparts; w < words * (p + 1) / wparts; ++w)
+                {
+                    for (uint64_t open = ~visited[w].load(std::memory_order_relaxed); open; open &= open - 1)
+                    {
+                        int v = (int)(w * 64 + __builtin_ctzll(open));
+                        if (v >= N)
+                            break;
+                        if (grid[v].blocked)
+                            continue;
+                        int x = v % gCols, y = v / gCols;
+                        uint32_t best = noRank;
+                        for (int e = 0; e < 4; ++e)
+                        {
+                            int u = index(x + dirs[e][0], y + dirs[e][1]), back = (e + 2) & 3;
+                            if (u >= 0 && out.dist[u] == level && !grid[u].walls[back])
+                                best = std::min(best, rank[u].load(std::memory_order_relaxed) * 4 + back);
+                        }
+                        if (best != noRank)
+                            rank[v].store(best, std::memory_order_relaxed);
+                    }
+                } });
+        }
+
+        parallelFor(parts, [&](int p)
+                    {
+            std::vector<int> &buf = local[p];
+            buf.clear();
+            size_t lo = frontier.size() * p / parts, hi = frontier.size() * (p + 1) / parts;
+            for (size_t i = lo; i < hi; ++i)
+            {
+                int u = frontier[i], x = u % gCols, y = u / gCols;
+                for (int d = 0; d < 4; ++d)
+                {
+                    int v = index(x + dirs[d][0], y + dirs[d][1]);
+                    // a stale rank from an earlier level can only belong to a visited cell
+                    if (v < 0 || rank[v].load(std::memory_order_relaxed) != (uint32_t)(i * 4 + d) || isVisited(v))
+                        continue;
+                    markVisited(v);
+                    out.dist[v] = level + 1;
+                    out.parent[v] = u;
+                    buf.push_back(v);
+                }
+            } });
+
+        offset[0] = 0;
+        for (int p = 0; p < parts; ++p)
+            offset[p + 1] = offset[p] + local[p].size();
+        next.resize(offset[parts]);
+        parallelFor(parts, [&](int p)
+                    {
+            for (size_t k = 0; k < local[p].size(); ++k)
+            {
+                next[offset[p] + k] = local[p][k];
+                rank[local[p][k]].store((uint32_t)(offset[p] + k), std::memory_order_relaxed);
+            } });
+        out.reached += frontier.size();
+        out.levels = level + 1;
+        unvisited -= next.size();
+        frontier.swap(next);
+    }
+    out.seconds = nowSeconds() - t0;
+}
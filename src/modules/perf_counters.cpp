@@ -0,0 +1,126 @@
+#include "../headers/perf_counters.h"
+#include "../headers/logging.h"
+#ifdef __linux__
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+const char *const perfCounterNames[PC_COUNT] = {"cycles", "instructions", "L1d misses", "LLC misses", "branch misses"};
+
+void PerfSample::add(const PerfSample &o)
+{
+    // A run the kernel gave nothing for a counter adds nothing to its average
+    for (int c = 0; c < PC_COUNT; ++c)
+        if (o.valid[c])
+        {
+            value[c] += o.value[c];
+            runs[c] += o.runs[c];
+            valid[c] = true;
+        }
+}
+
+#ifdef __linux__
+
+static int fds[PC_COUNT] = {-1, -1, -1, -1, -1};
+
+static int openCounter(uint32_t type, uint64_t config)
+{
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1; // also what perf_event_paranoid=2 allows unprivileged
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+int perfOpen()
+{
+    perfClose();
+    static const uint32_t types[PC_COUNT] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+                                             PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE};
+    static const uint64_t configs[PC_COUNT] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES};
+    int available = 0;
+    for (int c = 0; c < PC_COUNT; ++c)
+    {
+        fds[c] = openCounter(types[c], configs[c]);
+        if (fds[c] >= 0)
+        {
+            available++;
+            continue;
+        }
+        int err = errno;
+        logAt(LL_WARN, "perf counter '%s' unavailable: %s%s", perfCounterNames[c], strerror(err),
+              err == EACCES || err == EPERM ? " (see /proc/sys/kernel/perf_event_paranoid)" : "");
+    }
+    return available;
+}
+
+void perfStart()
+{
+    for (int c = 0; c < PC_COUNT; ++c)
+        if (fds[c] >= 0)
+        {
+            ioctl(fds[c], PERF_EVENT_IOC_RESET, 0);
+            ioctl(fds[c], PERF_EVENT_IOC_ENABLE, 0);
+        }
+}
+
+PerfSample perfStop()
+{
+    PerfSample s;
+    for (int c = 0; c < PC_COUNT; ++c)
+        if (fds[c] >= 0)
+            ioctl(fds[c], PERF_EVENT_IOC_DISABLE, 0);
+    for (int c = 0; c < PC_COUNT; ++c)
+    {
+        uint64_t r[3]; // value, time enabled, time running
+        if (fds[c] < 0 || read(fds[c], r, sizeof(r)) != (ssize_t)sizeof(r) || r[2] == 0)
+            continue;
+        // More counters than hardware slots: the kernel time-slices them, scale to the full window
+        s.value[c] = r[2] < r[1] ? (uint64_t)((double)r[0] * r[1] / r[2]) : r[0];
+        s.valid[c] = true;
+        s.runs[c] = 1;
+    }
+    return s;
+}
+
+void perfClose()
+{
+    for (int c = 0; c < PC_COUNT; ++c)
+        if (fds[c] >= 0)
+        {
+            close(fds[c]);
+            fds[c] = -1;
+        }
+}
+
+#else
+
+int perfOpen()
+{
+    logAt(LL_WARN, "hardware performance counters are only supported on Linux");
+    return 0;
+}
+
+void perfStart() {}
+
+PerfSample perfStop()
+{
+    return PerfSample();
+}
+
+void perfClose() {}
+
+#endif
@@ -0,0 +1,169 @@
+#include "../headers/playback.h"
+#include "../headers/solvers.h"
+
+static const size_t keyframeInterval = 256;
+
+// State before events[k * keyframeInterval]
+struct Keyframe
+{
+    int top;         // success node on top of the stack, -1 when empty
+    int pushes;      // success nodes created so far (id of the next one)
+    size_t failures; // failure segments drawn
+};
+
+static std::vector<int> nodeParent, nodeDepth, nodeEvent; // per success push
+static std::vector<int> failureEvent;                      // per failure segment
+static std::vector<Keyframe> keyframes;
+static bool popOnFailure = false; // DFS: a failed edge erases the last success segment
+static size_t timelineEvents = 0;
+static unsigned int timelineRevision = 0;
+static int timelineAlgo = -1;
+
+// What is currently in successVertices/failureVertices; stale after they are cleared directly
+static Keyframe cur = {-1, 0, 0};
+static bool curValid = false;
+
+static void step(Keyframe &s, size_t e)
+{
+    if (std::get<2>(events[e]))
+    {
+        s.top = s.pushes++;
+    }
+    else
+    {
+        if (popOnFailure && s.top != -1)
+            s.top = nodeParent[s.top];
+        s.failures++;
+    }
+}
+
+// Call once after a solver filled `events`
+void buildPlaybackTimeline()
+{
+    popOnFailure = (solveAlgo == 0);
+    timelineEvents = events.size();
+    timelineRevision = mazeRevision;
+    timelineAlgo = solveAlgo;
+    nodeParent.clear();
+    nodeDepth.clear();
+    nodeEvent.clear();
+    failureEvent.clear();
+    keyframes.clear();
+
+    Keyframe s = {-1, 0, 0};
+    for (size_t e = 0; e < events.size(); ++e)
+    {
+        if (e % keyframeInterval == 0)
+            keyframes.push_back(s);
+        if (std::get<2>(events[e]))
+        {
+            nodeParent.push_back(s.top);
+            nodeDepth.push_back(s.top == -1 ? 1 : nodeDepth[s.top] + 1);
+            nodeEvent.push_back((int)e);
+        }
+        else
+        {
+            failureEvent.push_back((int)e);
+        }
+        step(s, e);
+    }
+    cur = {-1, 0, 0};
+    curValid = successVertices.empty() && failureVertices.empty() && eventIndex == 0;
+}
+
+// The overlay was cleared behind our back; the next seek rebuilds it from scratch
+void invalidatePlayback() { curValid = false; }
+
+bool playbackReady() { return !events.empty() && events.size() == timelineEvents; }
+
+// Paused part-way through a run on the same maze and solver
+bool playbackCanResume()
+{
+    return playbackReady() && eventIndex > 0 && eventIndex < events.size() &&
+           timelineRevision == mazeRevision && timelineAlgo == solveAlgo;
+}
+
+// Advance one event (auto-play and the step button)
+void applyNextEvent()
+{
+    if (eventIndex >= events.size())
+        return;
+    auto [u, v, ok, wCost] = events[eventIndex];
+    if (ok)
+        pushSuccess(u, v);
+    else
+    {
+        if (playbackReady() ? popOnFailure : solveAlgo == 0)
+            popSuccess();
+        pushFailure(u, v);
+    }
+    if (playbackReady())
+        step(cur, eventIndex);
+    eventIndex++;
+}
+
+// Jump to the state after `target` events: O(keyframeInterval) to find the target
+// node, then only the segments that differ between the two stacks are touched.
+void seekPlayback(size_t target)
+{
+    if (!playbackReady())
+        return;
+    target = std::min(target, events.size());
+
+    size_t k = std::min(target / keyframeInterval, keyframes.size() - 1);
+    Keyframe tgt = keyframes[k];
+    for (size_t e = k * keyframeInterval; e < target; ++e)
+        step(tgt, e);
+
+    if (!curValid)
+    {
+        successVertices.clear();
+        failureVertices.clear();
+        successSynced = failureSynced = 0;
+        cur = {-1, 0, 0};
+        curValid = true;
+    }
+
+    // Success stack: pop down to the common ancestor, then push the target branch
+    int a = cur.top, b = tgt.top;
+    std::vector<int> branch;
+    auto depth = [](int n)
+    { return n == -1 ? 0 : nodeDepth[n]; };
+    while (depth(a) > depth(b))
+    {
+        popSuccess();
+        a = nodeParent[a];
+    }
+    while (depth(b) > depth(a))
+    {
+        branch.push_back(b);
+        b = nodeParent[b];
+    }
+    while (a != b)
+    {
+        popSuccess();
+        a = nodeParent[a];
+        branch.push_back(b);
+        b = nodeParent[b];
+    }
+    for (auto it = branch.rbegin(); it != branch.rend(); ++it)
+    {
+        auto &e = events[nodeEvent[*it]];
+        pushSuccess(std::get<0>(e), std::get<1>(e));
+    }
+
+    // Failure segments are append-only, so their state is just a count
+    if (tgt.failures < cur.failures)
+    {
+        failureVertices.resize(tgt.failures * 4);
+        failureSynced = std::min(failureSynced, failureVertices.size());
+    }
+    for (size_t f = cur.failures; f < tgt.failures; ++f)
+    {
+        auto &e = events[failureEvent[f]];
+        pushFailure(std::get<0>(e), std::get<1>(e));
+    }
+
+    cur = tgt;
+    eventIndex = target;
+}
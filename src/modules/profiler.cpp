@@ -0,0 +1,216 @@
+#include "../headers/profiler.h"
+#include "../headers/tracing.h"
+#include <chrono>
+
+bool profilerEnabled = false;
+
+static const char *phaseNames[PROF_COUNT] = {"Layer", "Walls", "Paths", "Sidebar UI", "ImGui::Render", "GL render"};
+static const int historyLen = 240; // frames kept for the graph, averages and p99
+static const int gpuLatency = 4;   // frames before a timestamp query is read back
+
+static double nowMs()
+{
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Rolling history: frame CPU time plus per-phase CPU and GPU times (ms)
+static float frameHist[historyLen];
+static float cpuHist[PROF_COUNT][historyLen], gpuHist[PROF_COUNT][historyLen];
+static int histPos = 0, histCount = 0;
+
+static double frameStart = 0.0, phaseStart[PROF_COUNT];
+static float cpuThisFrame[PROF_COUNT];
+static bool frameActive = false, phaseActive[PROF_COUNT];
+static bool traceFrame = false, tracePhase[PROF_COUNT]; // phases double as trace scopes
+static int drawLists = 0, drawCmds = 0, drawVtx = 0, drawIdx = 0;
+
+// GPU timestamps, double-buffered over gpuLatency frames so reads never stall
+static GLuint gpuQueries[gpuLatency][PROF_COUNT][2];
+static bool gpuIssued[gpuLatency][PROF_COUNT], gpuOpen[PROF_COUNT];
+static int gpuSlot = 0, gpuState = 0; // 0 untested, 1 ok, -1 unsupported
+static float gpuLatest[PROF_COUNT];
+
+static bool gpuReady()
+{
+    if (gpuState == 0)
+    {
+        gpuState = GLAD_GL_VERSION_3_3 ? 1 : -1; // the loader fetches glQueryCounter only for 3.3
+        if (gpuState > 0)
+            glGenQueries(gpuLatency * PROF_COUNT * 2, &gpuQueries[0][0][0]);
+    }
+    return gpuState > 0;
+}
+
+void profFrameBegin()
+{
+    traceFrame = traceEnabled;
+    if (traceFrame)
+        traceBegin("Frame");
+    frameActive = profilerEnabled;
+    if (!frameActive)
+        return;
+    frameStart = nowMs();
+    for (int p = 0; p < PROF_COUNT; ++p)
+    {
+        cpuThisFrame[p] = 0.0f;
+        phaseActive[p] = false;
+    }
+    if (!gpuReady())
+        return;
+    // Collect the slot issued gpuLatency frames ago before reusing it
+    gpuSlot = (gpuSlot + 1) % gpuLatency;
+    for (int p = 0; p < PROF_COUNT; ++p)
+    {
+        if (!gpuIssued[gpuSlot][p])
+            continue;
+        GLint ready = 0;
+        glGetQueryObjectiv(gpuQueries[gpuSlot][p][1], GL_QUERY_RESULT_AVAILABLE, &ready);
+        if (ready)
+        {
+            GLuint64 t0 = 0, t1 = 0;
+            glGetQueryObjectui64v(gpuQueries[gpuSlot][p][0], GL_QUERY_RESULT, &t0);
+            glGetQueryObjectui64v(gpuQueries[gpuSlot][p][1], GL_QUERY_RESULT, &t1);
+            gpuLatest[p] = (float)((t1 - t0) * 1e-6);
+        }
+        gpuIssued[gpuSlot][p] = false;
+    }
+}
+
+void profBegin(ProfPhase p)
+{
+    if (traceFrame && !tracePhase[p])
+    {
+        traceBegin(phaseNames[p]);
+        tracePhase[p] = true;
+    }
+    if (!frameActive)
+        return;
+    phaseStart[p] = nowMs();
+    phaseActive[p] = true;
+}
+
+void profEnd(ProfPhase p)
+{
+    if (tracePhase[p])
+    {
+        traceEnd(phaseNames[p]);
+        tracePhase[p] = false;
+    }
+    if (!frameActive || !phaseActive[p])
+        return;
+    cpuThisFrame[p] += (float)(nowMs() - phaseStart[p]);
+    phaseActive[p] = false;
+}
+
+// Timestamps (not GL_TIME_ELAPSED) so the callback scopes can nest inside GL render
+void profGpuBegin(ProfPhase p)
+{
+    if (!frameActive || gpuState <= 0 || gpuIssued[gpuSlot][p])
+        return;
+    glQueryCounter(gpuQueries[gpuSlot][p][0], GL_TIMESTAMP);
+    gpuOpen[p] = true;
+}
+
+void profGpuEnd(ProfPhase p)
+{
+    if (!gpuOpen[p])
+        return;
+    glQueryCounter(gpuQueries[gpuSlot][p][1], GL_TIMESTAMP);
+    gpuOpen[p] = false;
+    gpuIssued[gpuSlot][p] = true;
+}
+
+void profFrameEnd(const ImDrawData *drawData)
+{
+    if (traceFrame)
+    {
+        traceEnd("Frame");
+        traceFrame = false;
+        if (drawData)
+            traceCounter("ImGui vertices", drawData->TotalVtxCount);
+    }
+    if (!frameActive)
+        return;
+    frameActive = false;
+    frameHist[histPos] = (float)(nowMs() - frameStart);
+    for (int p = 0; p < PROF_COUNT; ++p)
+    {
+        cpuHist[p][histPos] = cpuThisFrame[p];
+        gpuHist[p][histPos] = gpuLatest[p];
+    }
+    histPos = (histPos + 1) % historyLen;
+    histCount = std::min(histCount + 1, historyLen);
+
+    drawLists = drawCmds = 0;
+    drawVtx = drawIdx = 0;
+    if (drawData)
+    {
+        drawLists = drawData->CmdListsCount;
+        drawVtx = drawData->TotalVtxCount;
+        drawIdx = drawData->TotalIdxCount;
+        for (int i = 0; i < drawData->CmdListsCount; ++i)
+            drawCmds += drawData->CmdLists.Data[i]->CmdBuffer.Size;
+    }
+}
+
+static float average(const float *v)
+{
+    if (!histCount)
+        return 0.0f;
+    double s = 0;
+    for (int i = 0; i < histCount; ++i)
+        s += v[i];
+    return (float)(s / histCount);
+}
+
+// Body of the collapsible "Profiler" section
+void drawProfilerPanel()
+{
+    if (!histCount)
+    {
+        ImGui::TextDisabled("collecting...");
+        return;
+    }
+    // Oldest-first copy for the graph, sorted copy for p99
+    float ordered[historyLen], sorted[historyLen];
+    for (int i = 0; i < histCount; ++i)
+        ordered[i] = frameHist[(histPos - histCount + i + historyLen) % historyLen];
+    std::copy(ordered, ordered + histCount, sorted);
+    std::sort(sorted, sorted + histCount);
+    float p99 = sorted[std::min(histCount - 1, (int)(histCount * 0.99f))];
+
+    char overlay[64];
+    snprintf(overlay, sizeof(overlay), "avg %.2f ms  p99 %.2f ms", average(frameHist), p99);
+    ImGui::PlotLines("##FrameTimes", ordered, histCount, 0, overlay, 0.0f, std::max(p99 * 1.5f, 1.0f),
+                     ImVec2(ImGui::GetContentRegionAvail().x * 0.9f, 60));
+
+    if (ImGui::BeginTable("##Phases", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+    {
+        ImGui::TableSetupColumn("Phase");
+        ImGui::TableSetupColumn("CPU ms");
+        ImGui::TableSetupColumn(gpuState > 0 ? "GPU ms" : "GPU n/a");
+        ImGui::TableHeadersRow();
+        for (int p = 0; p < PROF_COUNT; ++p)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(phaseNames[p]);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", average(cpuHist[p]));
+            ImGui::TableNextColumn();
+            if (gpuState > 0)
+                ImGui::Text("%.3f", average(gpuHist[p]));
+        }
+        ImGui::EndTable();
+    }
+    ImGui::Text("Draw lists %d, cmds %d", drawLists, drawCmds);
+    ImGui::Text("Vertices %d, indices %d", drawVtx, drawIdx);
+}
+
+void deleteProfiler()
+{
+    if (gpuState > 0)
+        glDeleteQueries(gpuLatency * PROF_COUNT * 2, &gpuQueries[0][0][0]);
+    gpuState = 0;
+}
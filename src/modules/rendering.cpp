@@ -1,5 +1,8 @@
 #include "../headers/rendering.h"
 #include "../headers/logging.h"
+#include "../headers/textures.h"
+#include "../headers/profiler.h"
+#include "../headers/tracing.h"
 
 void framebuffer_size_callback(GLFWwindow *, int width, int height)
 {
@@ -9,9 +12,11 @@ void framebuffer_size_callback(GLFWwindow *, int width, int height)
     glViewport(xoff, yoff, sz, sz);
 }
 
+// Projection of the square maze viewport: gCols / camZoom cells across, starting at the camera
 void buildProjection()
 {
-    proj = glm::ortho(0.0f, (float)gCols, (float)gRows, 0.0f);
+    float span = (float)gCols / camZoom;
+    proj = glm::ortho(camX, camX + span, camY + span, camY);
     if (shader)
     {
         glUseProgram(shader);
@@ -21,7 +26,8 @@ void buildProjection()
 
 ImTextureID toImguiTex(GLuint id) { return (ImTextureID)(intptr_t)id; }
 
-void computeViewportAndCell(float &xoff, float &yoff, float &cell, int &sz)
+// Square area right of the sidebar that the maze is drawn into
+void computeMazeSquare(float &sx, float &sy, int &sz)
 {
     int w, h;
     glfwGetFramebufferSize(gWindow, &w, &h);
@@ -37,37 +43,523 @@ void computeViewportAndCell(float &xoff, float &yoff, float &cell, int &sz)
     sz = std::min(availableWidth, h);
 
     // Position maze dynamically based on actual sidebar width
-    xoff = responsiveWidth + (float)(availableWidth - sz) * 0.5f;
-    yoff = (float)(h - sz) * 0.5f;
-    cell = (float)sz / (float)gCols;
+    sx = responsiveWidth + (float)(availableWidth - sz) * 0.5f;
+    sy = (float)(h - sz) * 0.5f;
+}
+
+// Screen position of grid cell (0,0) and the zoomed cell size; sz is the maze square
+void computeViewportAndCell(float &xoff, float &yoff, float &cell, int &sz)
+{
+    float sx, sy;
+    computeMazeSquare(sx, sy, sz);
+    cell = (float)sz / (float)gCols * camZoom;
+    xoff = sx - camX * cell;
+    yoff = sy - camY * cell;
+}
+
+// Half-open range of cells that intersect the maze square
+void visibleCellRange(int &x0, int &y0, int &x1, int &y1)
+{
+    float xoff, yoff, cell, sx, sy;
+    int sz;
+    computeViewportAndCell(xoff, yoff, cell, sz);
+    computeMazeSquare(sx, sy, sz);
+    x0 = std::clamp((int)std::floor((sx - xoff) / cell), 0, gCols);
+    y0 = std::clamp((int)std::floor((sy - yoff) / cell), 0, gRows);
+    x1 = std::clamp((int)std::ceil((sx + sz - xoff) / cell), 0, gCols);
+    y1 = std::clamp((int)std::ceil((sy + sz - yoff) / cell), 0, gRows);
+}
+
+// Cell under the mouse cursor, -1 when it is outside the maze square
+int cellUnderMouse()
+{
+    ImGuiIO &io = ImGui::GetIO();
+    float xoff, yoff, cell, sx, sy;
+    int sz;
+    computeViewportAndCell(xoff, yoff, cell, sz);
+    computeMazeSquare(sx, sy, sz);
+    float mx = io.MousePos.x, my = io.MousePos.y;
+    if (mx < sx || mx >= sx + sz || my < sy || my >= sy + sz)
+        return -1;
+    return index((int)std::floor((mx - xoff) / cell), (int)std::floor((my - yoff) / cell));
+}
+
+static void clampCamera()
+{
+    float maxZoom = std::max(1.0f, gCols / 4.0f); // at least 4 cells across
+    camZoom = std::clamp(camZoom, 1.0f, maxZoom);
+    float span = (float)gCols / camZoom;
+    camX = std::clamp(camX, 0.0f, std::max(0.0f, gCols - span));
+    camY = std::clamp(camY, 0.0f, std::max(0.0f, gRows - span));
+}
+
+void resetCamera()
+{
+    camZoom = 1.0f;
+    camX = camY = 0.0f;
+    buildProjection();
+}
+
+// Mouse wheel zooms around the cursor, right/middle drag pans
+void updateCamera()
+{
+    ImGuiIO &io = ImGui::GetIO();
+    float sx, sy;
+    int sz;
+    computeMazeSquare(sx, sy, sz);
+    float mx = io.MousePos.x, my = io.MousePos.y;
+    bool over = mx >= sx && mx < sx + sz && my >= sy && my < sy + sz;
+    float zoom0 = camZoom, x0 = camX, y0 = camY;
+
+    if (!io.WantCaptureMouse && over && io.MouseWheel != 0.0f)
+    {
+        float cell = (float)sz / gCols * camZoom;
+        float gx = camX + (mx - sx) / cell, gy = camY + (my - sy) / cell;
+        camZoom *= std::pow(1.2f, io.MouseWheel);
+        clampCamera();
+        cell = (float)sz / gCols * camZoom;
+        camX = gx - (mx - sx) / cell;
+        camY = gy - (my - sy) / cell;
+    }
+    if (!io.WantCaptureMouse && (ImGui::IsMouseDragging(1) || ImGui::IsMouseDragging(2)))
+    {
+        float cell = (float)sz / gCols * camZoom;
+        camX -= io.MouseDelta.x / cell;
+        camY -= io.MouseDelta.y / cell;
+    }
+    clampCamera();
+    if (camZoom != zoom0 || camX != x0 || camY != y0)
+        buildProjection();
+}
+
+// ---- GPU path: instanced quads through `shader` ----
+
+// Unit quad shared by every instanced draw (triangle strip)
+static unsigned int quadVBO = 0;
+static GLint locCorner = -1, locSeg = -1;
+static GLsizei wallInstanceCount = 0;
+static std::vector<int> wallCellStart; // first wall instance of every cell (+ end sentinel)
+static unsigned int wallRevision = ~0u;
+
+// background, start, end and obstacles as one instance buffer:
+// [0] background, [1] start, [2] end, [3] whole maze, [4..] obstacles
+static unsigned int spriteVAO = 0, spriteVBO = 0;
+static std::vector<float> spriteVertices;
+static GLsizei obstacleInstanceCount = 0;
+
+// Static maze layer (background, obstacles, walls, start/end) cached in an FBO
+static unsigned int layerFBO = 0, layerTex = 0;
+static int layerW = 0, layerH = 0;
+static unsigned int layerRevision = ~0u;
+static bool layerOk = false;
+
+// Level of detail: a gCols x gRows "wall density" texture with a CPU-built
+// box-filtered mip chain stands in for walls/obstacles when cells are too small
+static const float lodMinCellPx = 4.0f; // exact geometry from this cell size up
+static unsigned int lodTex = 0;
+static int lodLevels = 0;
+static unsigned int lodRevision = ~0u;
+static int layerLodLevel = -2;
+
+// Terrain costs as a gCols x gRows tint over the background (absent while flat)
+static unsigned int terrainTex = 0;
+static unsigned int terrainRevision = ~0u;
+static bool terrainVisible = false;
+static float layerCam[3] = {0, 0, 0}; // zoom, x, y the layer was drawn with
+
+static unsigned int makeSegmentVAO(unsigned int instanceVBO)
+{
+    unsigned int vao;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+    glEnableVertexAttribArray(locCorner);
+    glVertexAttribPointer(locCorner, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void *)0);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glEnableVertexAttribArray(locSeg);
+    glVertexAttribPointer(locSeg, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *)0);
+    glVertexAttribDivisor(locSeg, 1);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return vao;
+}
+
+void initRenderBuffers()
+{
+    if (!shader || !GLAD_GL_VERSION_3_3)
+    {
+        logf("Instanced wall rendering unavailable, using ImGui walls");
+        return;
+    }
+    locCorner = glGetAttribLocation(shader, "aCorner");
+    locSeg = glGetAttribLocation(shader, "aSeg");
+
+    static const float corners[8] = {0, 0, 1, 0, 0, 1, 1, 1};
+    glGenBuffers(1, &quadVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+
+    glGenBuffers(1, &wallVBO);
+    wallVAO = makeSegmentVAO(wallVBO);
+    glGenBuffers(1, &spriteVBO);
+    spriteVAO = makeSegmentVAO(spriteVBO);
+
+    glUseProgram(shader);
+    glUniform1i(glGetUniformLocation(shader, "uTexHori"), 0);
+    glUniform1i(glGetUniformLocation(shader, "uTexVerti"), 1);
+    glUseProgram(0);
+
+    glGenFramebuffers(1, &layerFBO);
+    glGenTextures(1, &layerTex);
+    layerOk = true;
+    wallRevision = layerRevision = lodRevision = ~0u;
+}
+
+static void deletePathBuffers();
+
+void deleteRenderBuffers()
+{
+    deletePathBuffers();
+    if (wallVAO)
+        glDeleteVertexArrays(1, &wallVAO);
+    if (spriteVAO)
+        glDeleteVertexArrays(1, &spriteVAO);
+    unsigned int bufs[3] = {wallVBO, spriteVBO, quadVBO};
+    glDeleteBuffers(3, bufs);
+    if (layerFBO)
+        glDeleteFramebuffers(1, &layerFBO);
+    if (layerTex)
+        glDeleteTextures(1, &layerTex);
+    if (lodTex)
+        glDeleteTextures(1, &lodTex);
+    lodTex = 0;
+    lodRevision = ~0u;
+    if (terrainTex)
+        glDeleteTextures(1, &terrainTex);
+    terrainTex = 0;
+    terrainRevision = ~0u;
+    terrainVisible = false;
+    wallVAO = wallVBO = spriteVAO = spriteVBO = quadVBO = layerFBO = layerTex = 0;
+    wallInstanceCount = obstacleInstanceCount = 0;
+    layerW = layerH = 0;
+    layerOk = false;
+}
+
+// re-upload wall segments only when the maze changed since the last upload
+static void syncWallBuffer()
+{
+    if (wallRevision == mazeRevision)
+        return;
+    buildWallVertices();
+    wallInstanceCount = (GLsizei)(wallVertices.size() / 4);
+    glBindBuffer(GL_ARRAY_BUFFER, wallVBO);
+    glBufferData(GL_ARRAY_BUFFER, wallVertices.size() * sizeof(float), wallVertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    wallRevision = mazeRevision;
+}
+
+// markerCells > 1 enlarges start/end around their cell so they stay visible on dense grids
+static void buildSpriteVertices(float markerCells, int x0, int y0, int x1, int y1)
+{
+    auto cellQuad = [&](int i, float size)
+    {
+        float x = (float)(i % gCols) + 0.5f * (1 - size), y = (float)(i / gCols) + 0.5f * (1 - size);
+        spriteVertices.insert(spriteVertices.end(), {x, y, x + size, y});
+    };
+    spriteVertices.clear();
+    spriteVertices.insert(spriteVertices.end(), {0.0f, 0.0f, (float)gCols, 0.0f});
+    cellQuad(startCell, markerCells);
+    cellQuad(endCell, markerCells);
+    spriteVertices.insert(spriteVertices.end(), {0.0f, 0.0f, (float)gCols, 0.0f}); // whole maze (LOD)
+    for (int y = y0; y < y1; y++)
+        for (int x = x0; x < x1; x++)
+            if (grid[y * gCols + x].blocked)
+                cellQuad(y * gCols + x, 1.0f);
+    obstacleInstanceCount = (GLsizei)(spriteVertices.size() / 4) - 4;
+    glBindBuffer(GL_ARRAY_BUFFER, spriteVBO);
+    glBufferData(GL_ARRAY_BUFFER, spriteVertices.size() * sizeof(float), spriteVertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+static void setSegmentUniforms(const glm::mat4 &p, float thickness, float offset, int useTex)
+{
+    glUniformMatrix4fv(glGetUniformLocation(shader, "uProjection"), 1, GL_FALSE, &p[0][0]);
+    glUniform1f(glGetUniformLocation(shader, "uThickness"), thickness);
+    glUniform1f(glGetUniformLocation(shader, "uOffset"), offset);
+    glUniform1i(glGetUniformLocation(shader, "uUseTex"), useTex);
+}
+
+static void bindTextures(GLuint hori, const AtlasRect &rh, GLuint verti, const AtlasRect &rv)
+{
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, verti);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, hori);
+    glUniform4f(glGetUniformLocation(shader, "uRectHori"), rh.uv0.x, rh.uv0.y, rh.uv1.x, rh.uv1.y);
+    glUniform4f(glGetUniformLocation(shader, "uRectVerti"), rv.uv0.x, rv.uv0.y, rv.uv1.x, rv.uv1.y);
+}
+
+// Only the walls of cells in [x0,x1) x [y0,y1): one call for full-width bands, one per row otherwise
+static void drawWallInstances(const glm::mat4 &p, int x0, int y0, int x1, int y1)
+{
+    if (x0 >= x1 || y0 >= y1)
+        return;
+    setSegmentUniforms(p, 0.08f, 0.0f, 1); // same 8% of a cell as the image walls
+    bindTextures(texLineHori, atlasRects[SPR_LINE_HORI], texLineVerti, atlasRects[SPR_LINE_VERTI]);
+    glBindVertexArray(wallVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, wallVBO);
+    auto drawRange = [&](int first, int last)
+    {
+        if (last <= first)
+            return;
+        glVertexAttribPointer(locSeg, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *)(first * 4 * sizeof(float)));
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, last - first);
+    };
+    if (x0 == 0 && x1 == gCols)
+        drawRange(wallCellStart[y0 * gCols], wallCellStart[y1 * gCols]);
+    else
+        for (int y = y0; y < y1; y++)
+            drawRange(wallCellStart[y * gCols + x0], wallCellStart[y * gCols + x1]);
+}
+
+static void drawSprites(const glm::mat4 &p, GLuint tex, const AtlasRect &r, int first, GLsizei count, float thickness)
+{
+    if (!tex || count <= 0)
+        return;
+    setSegmentUniforms(p, thickness, 0.0f, 1);
+    bindTextures(tex, r, tex, r);
+    glBindVertexArray(spriteVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, spriteVBO);
+    glVertexAttribPointer(locSeg, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *)(first * 4 * sizeof(float)));
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count);
+}
+
+// ---- Level of detail for grids denser than the screen ----
+
+static void syncLodTexture()
+{
+    if (lodRevision == mazeRevision)
+        return;
+    int w = gCols, h = gRows;
+    std::vector<unsigned char> cur(w * h * 4), next;
+    for (int i = 0; i < w * h; i++)
+    {
+        const Cell &c = grid[i];
+        unsigned char *t = &cur[i * 4];
+        if (c.blocked)
+        {
+            t[0] = 235, t[1] = 120, t[2] = 60, t[3] = 255; // obstacle orange
+            continue;
+        }
+        int n = c.walls[0] + c.walls[1] + c.walls[2] + c.walls[3];
+        t[0] = 235, t[1] = 225, t[2] = 255, t[3] = (unsigned char)(n * 255 / 4);
+    }
+
+    if (!lodTex)
+        glGenTextures(1, &lodTex);
+    glBindTexture(GL_TEXTURE_2D, lodTex);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    int level = 0;
+    for (;;)
+    {
+        glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, cur.data());
+        if (w == 1 && h == 1)
+            break;
+        int nw = std::max(1, w / 2), nh = std::max(1, h / 2);
+        next.assign(nw * nh * 4, 0);
+        for (int y = 0; y < nh; y++)
+            for (int x = 0; x < nw; x++)
+            {
+                int x0 = std::min(2 * x, w - 1), x1 = std::min(2 * x + 1, w - 1);
+                int y0 = std::min(2 * y, h - 1), y1 = std::min(2 * y + 1, h - 1);
+                for (int k = 0; k < 4; k++)
+                    next[(y * nw + x) * 4 + k] = (unsigned char)((cur[(y0 * w + x0) * 4 + k] + cur[(y0 * w + x1) * 4 + k] +
+                                                                  cur[(y1 * w + x0) * 4 + k] + cur[(y1 * w + x1) * 4 + k] + 2) / 4);
+            }
+        cur.swap(next);
+        w = nw;
+        h = nh;
+        level++;
+    }
+    lodLevels = level + 1;
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, lodLevels - 1);
+    lodRevision = mazeRevision;
+}
+
+// Rebuilds the terrain tint after maze edits; false while every cost is 1
+static bool syncTerrainTexture()
+{
+    if (terrainRevision == mazeRevision)
+        return terrainVisible;
+    terrainRevision = mazeRevision;
+    float maxCost = 1.0f;
+    for (const Cell &c : grid)
+        maxCost = std::max(maxCost, c.cost);
+    terrainVisible = maxCost > 1.0f;
+    if (!terrainVisible)
+        return false;
+
+    std::vector<unsigned char> px(gCols * gRows * 4);
+    for (int i = 0; i < gCols * gRows; i++)
+    {
+        unsigned char *t = &px[i * 4];
+        t[0] = 110, t[1] = 80, t[2] = 40; // earth brown, denser where it costs more
+        t[3] = (unsigned char)(200.0f * (grid[i].cost - 1.0f) / (maxCost - 1.0f));
+    }
+    if (!terrainTex)
+        glGenTextures(1, &terrainTex);
+    glBindTexture(GL_TEXTURE_2D, terrainTex);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, gCols, gRows, 0, GL_RGBA, GL_UNSIGNED_BYTE, px.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return true;
+}
+
+// -1 = exact geometry, otherwise the mip level matching cells-per-pixel
+static int chooseLodLevel(float cell)
+{
+    if (!lodEnabled || cell >= lodMinCellPx)
+        return -1;
+    float cellsPerPixel = 1.0f / cell;
+    return cellsPerPixel <= 1.0f ? 0 : (int)std::floor(std::log2(cellsPerPixel));
+}
+
+int currentLodLevel() { return layerOk ? layerLodLevel : -1; }
+
+// Redraw the cached layer when the maze was edited, the maze area was resized
+// or the camera moved; only visible cells are submitted
+static void updateStaticLayer(int w, int h)
+{
+    float cell = (float)w / (float)gCols * camZoom;
+    int lod = chooseLodLevel(cell);
+    if (layerRevision == mazeRevision && w == layerW && h == layerH && lod == layerLodLevel &&
+        layerCam[0] == camZoom && layerCam[1] == camX && layerCam[2] == camY)
+        return;
+    if (w != layerW || h != layerH)
+    {
+        glBindTexture(GL_TEXTURE_2D, layerTex);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindFramebuffer(GL_FRAMEBUFFER, layerFBO);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, layerTex, 0);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        {
+            logf("Static layer framebuffer incomplete (%dx%d), drawing maze per frame", w, h);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            layerOk = false;
+            return;
+        }
+        layerW = w;
+        layerH = h;
+    }
+    // markers never shrink below 8px so start/end stay findable on dense grids
+    float marker = std::max(1.0f, 8.0f / cell);
+    int x0, y0, x1, y1;
+    visibleCellRange(x0, y0, x1, y1);
+    buildSpriteVertices(marker, x0, y0, x1, y1);
+    if (lod >= 0)
+    {
+        syncLodTexture();
+        lod = std::min(lod, lodLevels - 1);
+        glBindTexture(GL_TEXTURE_2D, lodTex);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, lod);
+    }
+    else
+    {
+        syncWallBuffer();
+    }
+
+    // layer is the maze square seen through the camera
+    const glm::mat4 &p = proj;
+    glBindFramebuffer(GL_FRAMEBUFFER, layerFBO);
+    glViewport(0, 0, w, h);
+    glDisable(GL_SCISSOR_TEST);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glEnable(GL_BLEND);
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    glUseProgram(shader);
+    drawSprites(p, texBackground, atlasRects[SPR_BACKGROUND], 0, 1, (float)gCols); // square background
+    if (syncTerrainTexture())
+        drawSprites(p, terrainTex, AtlasRect(), 3, 1, (float)gRows);
+    if (lod >= 0)
+    {
+        drawSprites(p, lodTex, AtlasRect(), 3, 1, (float)gRows);
+    }
+    else
+    {
+        drawSprites(p, texObstacle, atlasRects[SPR_OBSTACLE], 4, obstacleInstanceCount, 1.0f);
+        drawWallInstances(p, x0, y0, x1, y1);
+    }
+    drawSprites(p, texStart, atlasRects[SPR_START], 1, 1, marker);
+    drawSprites(p, texEnd, atlasRects[SPR_END], 2, 1, marker);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glUseProgram(0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    layerRevision = mazeRevision;
+    layerLodLevel = lod;
+    layerCam[0] = camZoom, layerCam[1] = camX, layerCam[2] = camY;
 }
 
 // background, obstacles, start/end as images
 void drawTexturedLayer()
 {
-    float xoff, yoff, cell;
+    float xoff, yoff, cell, qx, qy;
     int sz;
     computeViewportAndCell(xoff, yoff, cell, sz);
+    computeMazeSquare(qx, qy, sz);
     ImDrawList *dl = ImGui::GetBackgroundDrawList();
 
-    // Background image fills the square area
+    // Whole visible maze as a single quad; walls are part of it
+    if (layerOk && sz > 0)
+    {
+        updateStaticLayer(sz, sz);
+        if (layerOk)
+        {
+            // FBO textures are stored bottom-up
+            dl->AddImage(toImguiTex(layerTex), ImVec2(qx, qy), ImVec2(qx + sz, qy + sz),
+                         ImVec2(0, 1), ImVec2(1, 0));
+            return;
+        }
+    }
+
+    dl->PushClipRect(ImVec2(qx, qy), ImVec2(qx + sz, qy + sz), true);
+    // Background image fills the square area of the grid
     if (texBackground)
         dl->AddImage(toImguiTex(texBackground),
                      ImVec2(xoff, yoff),
-                     ImVec2(xoff + sz, yoff + sz));
+                     ImVec2(xoff + gCols * cell, yoff + gCols * cell),
+                     atlasRects[SPR_BACKGROUND].uv0, atlasRects[SPR_BACKGROUND].uv1);
+    if (syncTerrainTexture())
+        dl->AddImage(toImguiTex(terrainTex), ImVec2(xoff, yoff), ImVec2(xoff + gCols * cell, yoff + gRows * cell));
 
     // obstacles
+    int cx0, cy0, cx1, cy1;
+    visibleCellRange(cx0, cy0, cx1, cy1);
     if (texObstacle)
     {
-        for (int i = 0; i < gCols * gRows; i++)
-        {
-            if (!grid[i].blocked)
-                continue;
-            int x = i % gCols, y = i / gCols;
-            float x0 = xoff + x * cell, y0 = yoff + y * cell;
-            float x1 = x0 + cell, y1 = y0 + cell;
-            dl->AddImage(toImguiTex(texObstacle), ImVec2(x0, y0), ImVec2(x1, y1));
-        }
+        for (int y = cy0; y < cy1; y++)
+            for (int x = cx0; x < cx1; x++)
+            {
+                if (!grid[y * gCols + x].blocked)
+                    continue;
+                float x0 = xoff + x * cell, y0 = yoff + y * cell;
+                float x1 = x0 + cell, y1 = y0 + cell;
+                dl->AddImage(toImguiTex(texObstacle), ImVec2(x0, y0), ImVec2(x1, y1),
+                             atlasRects[SPR_OBSTACLE].uv0, atlasRects[SPR_OBSTACLE].uv1);
+            }
     }
 
     // start
@@ -75,28 +567,53 @@ void drawTexturedLayer()
     {
         int sx = startCell % gCols, sy = startCell / gCols;
         float x0 = xoff + sx * cell, y0 = yoff + sy * cell;
-        dl->AddImage(toImguiTex(texStart), ImVec2(x0, y0), ImVec2(x0 + cell, y0 + cell));
+        dl->AddImage(toImguiTex(texStart), ImVec2(x0, y0), ImVec2(x0 + cell, y0 + cell),
+                     atlasRects[SPR_START].uv0, atlasRects[SPR_START].uv1);
     }
     // end
     if (texEnd)
     {
         int ex = endCell % gCols, ey = endCell / gCols;
         float x0 = xoff + ex * cell, y0 = yoff + ey * cell;
-        dl->AddImage(toImguiTex(texEnd), ImVec2(x0, y0), ImVec2(x0 + cell, y0 + cell));
+        dl->AddImage(toImguiTex(texEnd), ImVec2(x0, y0), ImVec2(x0 + cell, y0 + cell),
+                     atlasRects[SPR_END].uv0, atlasRects[SPR_END].uv1);
     }
+    dl->PopClipRect();
 }
 
-// draw maze walls as textured images (line.png)
-void drawWallsAsLines()
+// Viewport of the maze square for draw callbacks (GL origin is bottom-left)
+static void setMazeViewport()
 {
-    float xoff, yoff, cell;
-    int sz;
-    computeViewportAndCell(xoff, yoff, cell, sz);
-    ImDrawList *dl = ImGui::GetBackgroundDrawList();
+    float sx, sy;
+    int sz, w, h;
+    computeMazeSquare(sx, sy, sz);
+    glfwGetFramebufferSize(gWindow, &w, &h);
+    glViewport((GLint)sx, (GLint)(h - sy - sz), sz, sz);
+    glDisable(GL_SCISSOR_TEST);
+}
+
+// ImGui draw callback: walls of the visible cells, instanced
+static void drawWallsCallback(const ImDrawList *, const ImDrawCmd *)
+{
+    profGpuBegin(PROF_WALLS);
+    int x0, y0, x1, y1;
+    visibleCellRange(x0, y0, x1, y1);
+    setMazeViewport();
+    glUseProgram(shader);
+    drawWallInstances(proj, x0, y0, x1, y1);
+    glBindVertexArray(0);
+    profGpuEnd(PROF_WALLS);
+}
 
+// per-cell image walls, used when instancing is not available
+static void drawWallsImmediate(ImDrawList *dl, float xoff, float yoff, float cell)
+{
     float thickness = cell * 0.08f; // consistent thickness
-    for (int y = 0; y < gRows; ++y)
-        for (int x = 0; x < gCols; ++x)
+    const AtlasRect &hori = atlasRects[SPR_LINE_HORI], &verti = atlasRects[SPR_LINE_VERTI];
+    int cx0, cy0, cx1, cy1;
+    visibleCellRange(cx0, cy0, cx1, cy1);
+    for (int y = cy0; y < cy1; ++y)
+        for (int x = cx0; x < cx1; ++x)
         {
             int i = index(x, y);
             float xf = xoff + x * cell;
@@ -106,38 +623,188 @@ void drawWallsAsLines()
             {
                 ImVec2 p0(xf, yf);
                 ImVec2 p1(xf + cell, yf + thickness);
-                dl->AddImage(toImguiTex(texLineHori), p0, p1);
+                dl->AddImage(toImguiTex(texLineHori), p0, p1, hori.uv0, hori.uv1);
             }
             // Right wall (vertical)
             if (grid[i].walls[1] && texLineVerti)
             {
                 ImVec2 p0(xf + cell - thickness, yf);
                 ImVec2 p1(xf + cell, yf + cell);
-                dl->AddImage(toImguiTex(texLineVerti), p0, p1);
+                dl->AddImage(toImguiTex(texLineVerti), p0, p1, verti.uv0, verti.uv1);
             }
             // Bottom wall (horizontal)
             if (grid[i].walls[2] && texLineHori)
             {
                 ImVec2 p0(xf, yf + cell - thickness);
                 ImVec2 p1(xf + cell, yf + cell);
-                dl->AddImage(toImguiTex(texLineHori), p0, p1);
+                dl->AddImage(toImguiTex(texLineHori), p0, p1, hori.uv0, hori.uv1);
             }
             // Left wall (vertical)
             if (grid[i].walls[3] && texLineVerti)
             {
                 ImVec2 p0(xf, yf);
                 ImVec2 p1(xf + thickness, yf + cell);
-                dl->AddImage(toImguiTex(texLineVerti), p0, p1);
+                dl->AddImage(toImguiTex(texLineVerti), p0, p1, verti.uv0, verti.uv1);
             }
         }
+}
 
-    // outer border
+// draw maze walls as textured quads (lineHori/lineVerti.png)
+void drawWallsAsLines()
+{
+    float xoff, yoff, cell;
+    int sz;
+    computeViewportAndCell(xoff, yoff, cell, sz);
+    ImDrawList *dl = ImGui::GetBackgroundDrawList();
+
+    if (layerOk)
+    {
+        // already baked into the static layer
+    }
+    else if (wallVAO && texLineHori && texLineVerti)
+    {
+        syncWallBuffer();
+        dl->AddCallback(drawWallsCallback, nullptr);
+        dl->AddCallback(ImDrawCallback_ResetRenderState, nullptr);
+    }
+    else
+    {
+        float sx, sy;
+        computeMazeSquare(sx, sy, sz);
+        dl->PushClipRect(ImVec2(sx, sy), ImVec2(sx + sz, sy + sz), true);
+        drawWallsImmediate(dl, xoff, yoff, cell);
+        dl->PopClipRect();
+    }
+
+    // outer border around the maze square
     const ImU32 borderCol = IM_COL32(255, 80, 80, 255); // red border
-    float x0 = xoff, y0 = yoff, x1 = xoff + sz, y1 = yoff + sz;
+    float x0, y0;
+    computeMazeSquare(x0, y0, sz);
+    float x1 = x0 + sz, y1 = y0 + sz;
     dl->AddRect(ImVec2(x0, y0), ImVec2(x1, y1), borderCol, 0.0f, 0, std::max(2.0f, cell * 0.08f));
 }
 
-// draw success (purple) and failure (red) path segments as ImGui lines
+// Exploration lines mirrored into GPU buffers; only the tail past
+// successSynced/failureSynced is uploaded each frame
+struct PathBuffer
+{
+    unsigned int *vao, *vbo;
+    const std::vector<float> *src;
+    size_t *synced;
+    size_t capacity; // floats
+};
+static PathBuffer pathBuffers[2] = {
+    {&successVAO, &successVBO, &successVertices, &successSynced, 0},
+    {&failureVAO, &failureVBO, &failureVertices, &failureSynced, 0}};
+
+static void syncPathBuffer(PathBuffer &pb)
+{
+    const std::vector<float> &v = *pb.src;
+    size_t &synced = *pb.synced;
+    if (!*pb.vao)
+    {
+        glGenBuffers(1, pb.vbo);
+        *pb.vao = makeSegmentVAO(*pb.vbo);
+    }
+    if (synced > v.size())
+        synced = v.size();
+    if (synced == v.size())
+        return;
+    glBindBuffer(GL_ARRAY_BUFFER, *pb.vbo);
+    if (v.size() > pb.capacity)
+    {
+        // grow geometrically and re-upload everything once
+        pb.capacity = std::max(v.size(), pb.capacity * 2);
+        glBufferData(GL_ARRAY_BUFFER, pb.capacity * sizeof(float), nullptr, GL_DYNAMIC_DRAW);
+        synced = 0;
+    }
+    glBufferSubData(GL_ARRAY_BUFFER, synced * sizeof(float), (v.size() - synced) * sizeof(float), v.data() + synced);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    synced = v.size();
+}
+
+static void drawPathsCallback(const ImDrawList *, const ImDrawCmd *)
+{
+    profGpuBegin(PROF_PATHS);
+    float xoff, yoff, cell;
+    int sz;
+    computeViewportAndCell(xoff, yoff, cell, sz);
+    setMazeViewport();
+    glUseProgram(shader);
+
+    // one draw call per colour, same pixel widths as the ImGui lines
+    struct { PathBuffer &pb; float r, g, b, thick; } layers[2] = {
+        {pathBuffers[0], 180 / 255.0f, 80 / 255.0f, 1.0f, std::max(2.0f, cell * 0.10f)}, // purple
+        {pathBuffers[1], 1.0f, 153 / 255.0f, 153 / 255.0f, std::max(1.5f, cell * 0.06f)}};
+    for (auto &l : layers)
+    {
+        GLsizei count = (GLsizei)(l.pb.src->size() / 4);
+        if (count == 0)
+            continue;
+        setSegmentUniforms(proj, l.thick / cell, -0.5f, 0);
+        glUniform3f(glGetUniformLocation(shader, "uColor"), l.r, l.g, l.b);
+        glBindVertexArray(*l.pb.vao);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count);
+    }
+    glBindVertexArray(0);
+    profGpuEnd(PROF_PATHS);
+}
+
+static void deletePathBuffers()
+{
+    for (auto &pb : pathBuffers)
+    {
+        if (*pb.vao)
+            glDeleteVertexArrays(1, pb.vao);
+        if (*pb.vbo)
+            glDeleteBuffers(1, pb.vbo);
+        *pb.vao = *pb.vbo = 0;
+        *pb.synced = 0;
+        pb.capacity = 0;
+    }
+}
+
+// Without instancing, segment numbers are bucketed by the 32x32-cell tile of
+// their first end, so a frame only walks the tiles in view. The synced counters
+// that the GPU buffers use say how much of each vector is bucketed.
+static const int segmentTile = 32;
+struct SegmentTiles
+{
+    std::vector<std::vector<int>> tiles; // segment numbers, ascending
+    int cols = 0, rows = 0;
+    size_t count = 0; // segments bucketed
+};
+static SegmentTiles segmentTiles[2];
+
+static void syncSegmentTiles(SegmentTiles &t, const std::vector<float> &v, size_t &synced)
+{
+    int cols = (gCols + segmentTile - 1) / segmentTile, rows = (gRows + segmentTile - 1) / segmentTile;
+    if (t.cols != cols || t.rows != rows)
+    {
+        t.tiles.assign((size_t)cols * rows, {});
+        t.cols = cols;
+        t.rows = rows;
+        t.count = 0;
+    }
+    size_t keep = std::min({synced, v.size(), t.count * 4}) / 4;
+    if (keep < t.count)
+    {
+        // cleared or cut back: later segments sit at the end of each tile
+        for (auto &tile : t.tiles)
+            while (!tile.empty() && (size_t)tile.back() >= keep)
+                tile.pop_back();
+        t.count = keep;
+    }
+    for (; t.count < v.size() / 4; ++t.count)
+    {
+        int x = std::clamp((int)v[t.count * 4], 0, gCols - 1) / segmentTile;
+        int y = std::clamp((int)v[t.count * 4 + 1], 0, gRows - 1) / segmentTile;
+        t.tiles[(size_t)y * cols + x].push_back((int)t.count);
+    }
+    synced = v.size();
+}
+
+// draw success (purple) and failure (red) path segments
 void drawPathsAsLines()
 {
     float xoff, yoff, cell;
@@ -145,31 +812,64 @@ void drawPathsAsLines()
     computeViewportAndCell(xoff, yoff, cell, sz);
     ImDrawList *dl = ImGui::GetBackgroundDrawList();
 
-    auto drawPairs = [&](const std::vector<float> &v, ImU32 c, float thick)
+    if (wallVAO)
     {
-        for (size_t i = 0; i + 3 < v.size(); i += 4)
+        syncPathBuffer(pathBuffers[0]);
+        syncPathBuffer(pathBuffers[1]);
+        if (!successVertices.empty() || !failureVertices.empty())
         {
-            float ux = xoff + v[i + 0] * cell;
-            float uy = yoff + v[i + 1] * cell;
-            float vx = xoff + v[i + 2] * cell;
-            float vy = yoff + v[i + 3] * cell;
-            dl->AddLine(ImVec2(ux, uy), ImVec2(vx, vy), c, thick);
+            dl->AddCallback(drawPathsCallback, nullptr);
+            dl->AddCallback(ImDrawCallback_ResetRenderState, nullptr);
         }
+        return;
+    }
+
+    int cx0, cy0, cx1, cy1;
+    visibleCellRange(cx0, cy0, cx1, cy1);
+    syncSegmentTiles(segmentTiles[0], successVertices, successSynced);
+    syncSegmentTiles(segmentTiles[1], failureVertices, failureSynced);
+    auto drawPairs = [&](const SegmentTiles &t, const std::vector<float> &v, ImU32 c, float thick)
+    {
+        // a segment reaches one cell past the tile of its first end
+        int tx0 = std::max(0, cx0 - 1) / segmentTile, tx1 = std::min(gCols - 1, cx1) / segmentTile;
+        int ty0 = std::max(0, cy0 - 1) / segmentTile, ty1 = std::min(gRows - 1, cy1) / segmentTile;
+        for (int ty = ty0; ty <= ty1; ++ty)
+            for (int tx = tx0; tx <= tx1; ++tx)
+                for (int s : t.tiles[(size_t)ty * t.cols + tx])
+                {
+                    size_t i = (size_t)s * 4;
+                    // segments join neighbouring cell centres, so a cell-range test is enough
+                    if (std::max(v[i], v[i + 2]) < cx0 || std::min(v[i], v[i + 2]) > cx1 ||
+                        std::max(v[i + 1], v[i + 3]) < cy0 || std::min(v[i + 1], v[i + 3]) > cy1)
+                        continue;
+                    float ux = xoff + v[i + 0] * cell;
+                    float uy = yoff + v[i + 1] * cell;
+                    float vx = xoff + v[i + 2] * cell;
+                    float vy = yoff + v[i + 3] * cell;
+                    dl->AddLine(ImVec2(ux, uy), ImVec2(vx, vy), c, thick);
+                }
     };
 
     float thickSuccess = std::max(2.0f, cell * 0.10f);
     float thickFail = std::max(1.5f, cell * 0.06f);
-    drawPairs(successVertices, IM_COL32(180, 80, 255, 255), thickSuccess); // purple
-    drawPairs(failureVertices, IM_COL32(255, 153, 153, 255), thickFail);
+    float sx, sy;
+    computeMazeSquare(sx, sy, sz);
+    dl->PushClipRect(ImVec2(sx, sy), ImVec2(sx + sz, sy + sz), true);
+    drawPairs(segmentTiles[0], successVertices, IM_COL32(180, 80, 255, 255), thickSuccess); // purple
+    drawPairs(segmentTiles[1], failureVertices, IM_COL32(255, 153, 153, 255), thickFail);
+    dl->PopClipRect();
 }
 
 void buildWallVertices()
 {
+    TraceScope trace("buildWallVertices");
     wallVertices.clear();
+    wallCellStart.resize(gCols * gRows + 1);
     for (int y = 0; y < gRows; y++)
         for (int x = 0; x < gCols; x++)
         {
             int i = index(x, y);
+            wallCellStart[i] = (int)(wallVertices.size() / 4);
             float xf = (float)x, yf = (float)y;
             if (grid[i].walls[0])
                 wallVertices.insert(wallVertices.end(), {xf, yf, xf + 1, yf});
@@ -180,6 +880,7 @@ void buildWallVertices()
             if (grid[i].walls[3])
                 wallVertices.insert(wallVertices.end(), {xf, yf + 1, xf, yf});
         }
+    wallCellStart[gCols * gRows] = (int)(wallVertices.size() / 4);
 }
 
 void rebuildBorderVAO() { /* no-op for ImGui walls */ }
@@ -201,7 +902,8 @@ void drawSplashScreen()
     {
         ImVec2 splashPos = ImVec2(viewport->Pos.x, viewport->Pos.y + yOffset);
         ImVec2 splashEnd = ImVec2(viewport->Pos.x + windowWidth, viewport->Pos.y + windowHeight + yOffset);
-        dl->AddImage(toImguiTex(texSplashScreen), splashPos, splashEnd);
+        dl->AddImage(toImguiTex(texSplashScreen), splashPos, splashEnd,
+                     atlasRects[SPR_SPLASH].uv0, atlasRects[SPR_SPLASH].uv1);
     }
     
     // If animation is complete, hide splash screen
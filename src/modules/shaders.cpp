@@ -1,29 +1,85 @@
 #include "../headers/shaders.h"
 #include "../headers/logging.h"
 
+// Walls are drawn as instanced quads: every instance is one segment (x0,y0,x1,y1)
+// in grid space, extruded to its right-hand side (the inside of the cell it was
+// emitted for) by uThickness. uOffset = -0.5 centres the quad on the segment.
+// uRectHori/uRectVerti select the sprite's sub-rectangle of the texture atlas.
 const char *VS_330 =
     "#version 330 core\n"
-    "layout(location=0) in vec2 aPos;\n"
+    "layout(location=0) in vec2 aCorner;\n"
+    "layout(location=1) in vec4 aSeg;\n"
     "uniform mat4 uProjection;\n"
-    "void main(){ gl_Position = uProjection * vec4(aPos,0,1); }\n";
+    "uniform float uThickness;\n"
+    "uniform float uOffset;\n"
+    "out vec2 vUV;\n"
+    "flat out int vHori;\n"
+    "void main(){\n"
+    "  vec2 a = aSeg.xy, b = aSeg.zw, d = b - a;\n"
+    "  vec2 n = normalize(vec2(-d.y, d.x));\n"
+    "  float t0 = uOffset * uThickness, t1 = t0 + uThickness;\n"
+    "  vec2 p = mix(a, b, aCorner.x) + n * mix(t0, t1, aCorner.y);\n"
+    "  vec2 lo = min(min(a + n * t0, b + n * t0), min(a + n * t1, b + n * t1));\n"
+    "  vec2 hi = max(max(a + n * t0, b + n * t0), max(a + n * t1, b + n * t1));\n"
+    "  vUV = (p - lo) / max(hi - lo, vec2(1e-6));\n"
+    "  vHori = abs(d.x) >= abs(d.y) ? 1 : 0;\n"
+    "  gl_Position = uProjection * vec4(p,0,1);\n"
+    "}\n";
 
 const char *FS_330 =
     "#version 330 core\n"
+    "in vec2 vUV;\n"
+    "flat in int vHori;\n"
     "out vec4 FragColor;\n"
     "uniform vec3 uColor;\n"
-    "void main(){ FragColor = vec4(uColor,1); }\n";
+    "uniform int uUseTex;\n"
+    "uniform sampler2D uTexHori;\n"
+    "uniform sampler2D uTexVerti;\n"
+    "uniform vec4 uRectHori;\n"
+    "uniform vec4 uRectVerti;\n"
+    "void main(){\n"
+    "  vec2 uvH = mix(uRectHori.xy, uRectHori.zw, vUV), uvV = mix(uRectVerti.xy, uRectVerti.zw, vUV);\n"
+    "  vec4 t = mix(texture(uTexVerti, uvV), texture(uTexHori, uvH), float(vHori));\n"
+    "  FragColor = uUseTex == 1 ? t : vec4(uColor,1);\n"
+    "}\n";
 
 const char *VS_150 =
     "#version 150\n"
-    "in vec2 aPos;\n"
+    "in vec2 aCorner;\n"
+    "in vec4 aSeg;\n"
     "uniform mat4 uProjection;\n"
-    "void main(){ gl_Position = uProjection * vec4(aPos,0,1); }\n";
+    "uniform float uThickness;\n"
+    "uniform float uOffset;\n"
+    "out vec2 vUV;\n"
+    "flat out int vHori;\n"
+    "void main(){\n"
+    "  vec2 a = aSeg.xy, b = aSeg.zw, d = b - a;\n"
+    "  vec2 n = normalize(vec2(-d.y, d.x));\n"
+    "  float t0 = uOffset * uThickness, t1 = t0 + uThickness;\n"
+    "  vec2 p = mix(a, b, aCorner.x) + n * mix(t0, t1, aCorner.y);\n"
+    "  vec2 lo = min(min(a + n * t0, b + n * t0), min(a + n * t1, b + n * t1));\n"
+    "  vec2 hi = max(max(a + n * t0, b + n * t0), max(a + n * t1, b + n * t1));\n"
+    "  vUV = (p - lo) / max(hi - lo, vec2(1e-6));\n"
+    "  vHori = abs(d.x) >= abs(d.y) ? 1 : 0;\n"
+    "  gl_Position = uProjection * vec4(p,0,1);\n"
+    "}\n";
 
 const char *FS_150 =
     "#version 150\n"
+    "in vec2 vUV;\n"
+    "flat in int vHori;\n"
     "out vec4 FragColor;\n"
     "uniform vec3 uColor;\n"
-    "void main(){ FragColor = vec4(uColor,1); }\n";
+    "uniform int uUseTex;\n"
+    "uniform sampler2D uTexHori;\n"
+    "uniform sampler2D uTexVerti;\n"
+    "uniform vec4 uRectHori;\n"
+    "uniform vec4 uRectVerti;\n"
+    "void main(){\n"
+    "  vec2 uvH = mix(uRectHori.xy, uRectHori.zw, vUV), uvV = mix(uRectVerti.xy, uRectVerti.zw, vUV);\n"
+    "  vec4 t = mix(texture(uTexVerti, uvV), texture(uTexHori, uvH), float(vHori));\n"
+    "  FragColor = uUseTex == 1 ? t : vec4(uColor,1);\n"
+    "}\n";
 
 unsigned int compileShader(unsigned int type, const char *src)
 {
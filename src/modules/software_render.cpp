@@ -0,0 +1,169 @@
+#include "../headers/software_render.h"
+#include "../headers/parallel.h"
+#include "../headers/tracing.h"
+
+const uint32_t renderPalette[RC_COUNT] = {
+    0x1C1A2E, // floor
+    0xE6E6F0, // wall
+    0x5A463C, // obstacle
+    0x50DC78, // start
+    0xF05050, // end
+    0xFF9999, // failure (same as the GUI)
+    0xB450FF, // success (same as the GUI)
+    0xFFD700, // final path
+};
+
+// Direction bit of the edge u -> v (adjacent cells), in Cell::walls order
+static int edgeDir(int u, int v)
+{
+    if (v == u - gCols)
+        return 0;
+    if (v == u + 1)
+        return 1;
+    if (v == u + gCols)
+        return 2;
+    return 3;
+}
+
+static void setEdge(std::vector<uint8_t> &bits, int u, int v, bool on)
+{
+    int d = edgeDir(u, v);
+    if (on)
+    {
+        bits[u] |= 1 << d;
+        bits[v] |= 1 << ((d + 2) & 3);
+    }
+    else
+    {
+        bits[u] &= ~(1 << d);
+        bits[v] &= ~(1 << ((d + 2) & 3));
+    }
+}
+
+void OverlayState::reset()
+{
+    size_t n = (size_t)gCols * gRows;
+    success.assign(n, 0);
+    failure.assign(n, 0);
+    path.clear();
+    stack.clear();
+    applied = 0;
+    popOnFailure = (solveAlgo == 0); // same DFS backtrack rule as playback
+}
+
+void OverlayState::advanceTo(size_t eventCount)
+{
+    eventCount = std::min(eventCount, events.size());
+    for (; applied < eventCount; ++applied)
+    {
+        auto [u, v, ok, wCost] = events[applied];
+        if (ok)
+        {
+            setEdge(success, u, v, true);
+            if (popOnFailure)
+                stack.emplace_back(u, v);
+        }
+        else
+        {
+            if (popOnFailure && !stack.empty())
+            {
+                setEdge(success, stack.back().first, stack.back().second, false);
+                stack.pop_back();
+            }
+            setEdge(failure, u, v, true);
+        }
+    }
+}
+
+void OverlayState::showPath(bool show)
+{
+    path.clear();
+    if (!show)
+        return;
+    path.assign((size_t)gCols * gRows, 0);
+    for (auto &e : finalPathEdges)
+        setEdge(path, e.first, e.second, true);
+}
+
+// Is (dx, dy), relative to the cell centre, on one of the half-segments in `bits`?
+static inline bool onLine(uint8_t bits, float dx, float dy, float hw)
+{
+    if (!bits)
+        return false;
+    float ax = std::fabs(dx), ay = std::fabs(dy);
+    if (ax <= hw && ay <= hw)
+        return true;
+    if (ax <= hw && ((dy < 0 && (bits & 1)) || (dy > 0 && (bits & 4))))
+        return true;
+    return ay <= hw && ((dx > 0 && (bits & 2)) || (dx < 0 && (bits & 8)));
+}
+
+// Point-samples every pixel's cell, so cost is O(pixels) however many cells the
+// maze has; tiles are independent and shaded in parallel.
+void renderMazeFrame(SoftwareImage &img, int width, const OverlayState &overlay)
+{
+    TraceScope trace("renderMazeFrame");
+    img.w = std::max(1, width);
+    img.h = std::max(1, (int)std::lround((double)img.w * gRows / gCols));
+    img.px.resize((size_t)img.w * img.h);
+
+    // Pixel centre -> cell and position inside it, per column and per row
+    std::vector<int> cellX(img.w), cellY(img.h);
+    std::vector<float> fracX(img.w), fracY(img.h);
+    for (int x = 0; x < img.w; ++x)
+    {
+        double g = (x + 0.5) * gCols / img.w;
+        cellX[x] = std::min(gCols - 1, (int)g);
+        fracX[x] = (float)(g - cellX[x]);
+    }
+    for (int y = 0; y < img.h; ++y)
+    {
+        double g = (y + 0.5) * gRows / img.h;
+        cellY[y] = std::min(gRows - 1, (int)g);
+        fracY[y] = (float)(g - cellY[y]);
+    }
+
+    // Thicknesses in cell units, matching the GUI proportions with a 1px floor
+    float cellPx = (float)img.w / gCols;
+    float wallHalf = std::min(0.5f, std::max(0.04f, 0.6f / cellPx)); // >= 1px across the shared edge
+    float succHalf = std::min(0.5f, std::max(0.05f, 1.0f / cellPx));
+    float failHalf = std::min(0.5f, std::max(0.03f, 0.75f / cellPx));
+    const float markerR2 = 0.4f * 0.4f;
+    bool hasPath = !overlay.path.empty();
+    bool hasOverlay = !overlay.success.empty();
+
+    const int tile = 64;
+    int tilesX = (img.w + tile - 1) / tile, tilesY = (img.h + tile - 1) / tile;
+    parallelFor(tilesX * tilesY, [&](int t)
+                {
+        int tx0 = (t % tilesX) * tile, ty0 = (t / tilesX) * tile;
+        int tx1 = std::min(img.w, tx0 + tile), ty1 = std::min(img.h, ty0 + tile);
+        for (int y = ty0; y < ty1; ++y)
+        {
+            uint8_t *row = &img.px[(size_t)y * img.w];
+            float fy = fracY[y], dy = fy - 0.5f;
+            int rowBase = cellY[y] * gCols;
+            for (int x = tx0; x < tx1; ++x)
+            {
+                int ci = rowBase + cellX[x];
+                const Cell &c = grid[ci];
+                float fx = fracX[x], dx = fx - 0.5f;
+                uint8_t col = c.blocked ? RC_OBSTACLE : RC_FLOOR;
+                if ((ci == startCell || ci == endCell) && dx * dx + dy * dy <= markerR2)
+                    col = ci == startCell ? RC_START : RC_END;
+                if ((c.walls[0] && fy < wallHalf) || (c.walls[2] && fy > 1.0f - wallHalf) ||
+                    (c.walls[3] && fx < wallHalf) || (c.walls[1] && fx > 1.0f - wallHalf))
+                    col = RC_WALL;
+                if (hasOverlay)
+                {
+                    if (onLine(overlay.failure[ci], dx, dy, failHalf))
+                        col = RC_FAILURE;
+                    if (onLine(overlay.success[ci], dx, dy, succHalf))
+                        col = RC_SUCCESS;
+                }
+                if (hasPath && onLine(overlay.path[ci], dx, dy, succHalf))
+                    col = RC_PATH;
+                row[x] = col;
+            }
+        } });
+}
@@ -1,5 +1,32 @@
 #include "../headers/solvers.h"
+#include "../headers/components.h"
+#include "../headers/dead_ends.h"
+#include "../headers/hpa.h"
+#include "../headers/contraction.h"
+#include "../headers/lpa.h"
+#include "../headers/flow_field.h"
 #include "../headers/logging.h"
+#include "../headers/tracing.h"
+#include "../headers/parallel.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+const char *const solverNames[SOLVER_COUNT] = {"DFS", "BFS", "Dijkstra", "A*", "Delta-step", "HPA*", "CH", "LPA*", "Flow field"};
+
+// Cells runSolver has ruled out on top of the obstacles (dead-end fill), or null
+static const uint8_t *skipCells = nullptr;
+
+static bool closed(int v)
+{
+    return grid[v].blocked || (skipCells && skipCells[v]);
+}
+
+static double nowSeconds()
+{
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
 
 void resetAnimationBuffers()
 {
@@ -8,6 +35,7 @@ void resetAnimationBuffers()
     finalPathEdges.clear();
     successVertices.clear();
     failureVertices.clear();
+    successSynced = failureSynced = 0;
     eventIndex = 0;
     animState = 0;
 }
@@ -31,35 +59,70 @@ void pushFailure(int u, int v)
     failureVertices.insert(failureVertices.end(), {ux, uy, vx, vy});
 }
 
-void solveDFS()
+// DFS backtrack: drop the last success segment; the GPU copy just draws one fewer
+void popSuccess()
+{
+    if (successVertices.size() < 4)
+        return;
+    successVertices.resize(successVertices.size() - 4);
+    successSynced = std::min(successSynced, successVertices.size());
+}
+
+SolveStats solveDFS()
 {
+    TraceScope trace("solveDFS");
+    SolveStats stats;
+    double t0 = nowSeconds();
     int N = gCols * gRows;
     std::vector<bool> vis(N, false);
-    std::function<bool(int)> dfsRec = [&](int u)
+    // explicit stack instead of recursion so large grids cannot overflow the call stack;
+    // emits exactly the events the recursive version did
+    struct Frame
+    {
+        int u, dir;
+    };
+    std::vector<Frame> st;
+    static const int dirs[4][3] = {{0, -1, 0}, {1, 0, 1}, {0, 1, 2}, {-1, 0, 3}};
+    vis[startCell] = true;
+    st.push_back({startCell, 0});
+    stats.nodesExpanded = 1;
+    while (!st.empty())
     {
+        int u = st.back().u;
         if (u == endCell)
-            return true;
-        int x = u % gCols, y = u / gCols;
-        static const int dirs[4][3] = {{0, -1, 0}, {1, 0, 1}, {0, 1, 2}, {-1, 0, 3}};
-        for (auto &d : dirs)
         {
-            int v = index(x + d[0], y + d[1]);
-            if (v < 0 || grid[u].walls[d[2]] || vis[v] || grid[v].blocked)
-                continue;
-            vis[v] = true;
-            pushEvent(u, v, true);
-            if (dfsRec(v))
-                return true;
-            pushEvent(u, v, false);
+            stats.pathLength = st.size() - 1;
+            break;
         }
-        return false;
-    };
-    vis[startCell] = true;
-    dfsRec(startCell);
+        if (st.back().dir == 4)
+        {
+            st.pop_back();
+            if (!st.empty())
+                pushEvent(st.back().u, u, false);
+            continue;
+        }
+        const int *d = dirs[st.back().dir++];
+        int x = u % gCols, y = u / gCols;
+        int v = index(x + d[0], y + d[1]);
+        if (v < 0 || grid[u].walls[d[2]] || vis[v] || closed(v))
+            continue;
+        vis[v] = true;
+        pushEvent(u, v, true);
+        st.push_back({v, 0});
+        stats.nodesExpanded++;
+        stats.edgesRelaxed++;
+        stats.peakFrontier = std::max(stats.peakFrontier, st.size());
+    }
+    stats.scratchBytes = N / 8 + st.capacity() * sizeof(Frame);
+    stats.seconds = nowSeconds() - t0;
+    return stats;
 }
 
-void solveBFS()
+SolveStats solveBFS()
 {
+    TraceScope trace("solveBFS");
+    SolveStats stats;
+    double t0 = nowSeconds();
     int N = gCols * gRows;
     std::vector<bool> vis(N, false);
     std::vector<int> parent(N, -1);
@@ -69,20 +132,23 @@ void solveBFS()
     static const int dirs[4][3] = {{0, -1, 0}, {1, 0, 1}, {0, 1, 2}, {-1, 0, 3}};
     while (!q.empty())
     {
+        stats.peakFrontier = std::max(stats.peakFrontier, q.size());
         int u = q.front();
         q.pop();
+        stats.nodesExpanded++;
         if (u == endCell)
             break;
         int x = u % gCols, y = u / gCols;
         for (auto &d : dirs)
         {
             int v = index(x + d[0], y + d[1]);
-            if (v < 0 || grid[u].walls[d[2]] || vis[v] || grid[v].blocked)
+            if (v < 0 || grid[u].walls[d[2]] || vis[v] || closed(v))
                 continue;
             pushEvent(u, v, false);
             vis[v] = true;
             parent[v] = u;
             q.push(v);
+            stats.edgesRelaxed++;
         }
     }
     finalPathEdges.clear();
@@ -103,10 +169,17 @@ void solveBFS()
         if (pathSet.count({u, v}))
             std::get<2>(e) = true;
     }
+    stats.pathLength = finalPathEdges.size();
+    stats.scratchBytes = N / 8 + N * sizeof(int) + stats.peakFrontier * sizeof(int);
+    stats.seconds = nowSeconds() - t0;
+    return stats;
 }
 
-void solveDijkstra()
+SolveStats solveDijkstra()
 {
+    TraceScope trace("solveDijkstra");
+    SolveStats stats;
+    double t0 = nowSeconds();
     int N = gCols * gRows;
     const float INF = std::numeric_limits<float>::infinity();
     std::vector<float> dist(N, INF);
@@ -120,25 +193,31 @@ void solveDijkstra()
 
     while (!pq.empty())
     {
+        stats.peakFrontier = std::max(stats.peakFrontier, pq.size());
         auto [du, u] = pq.top();
         pq.pop();
         if (du != dist[u])
+        {
+            stats.stalePops++;
             continue;
+        }
+        stats.nodesExpanded++;
         if (u == endCell)
             break;
         int x = u % gCols, y = u / gCols;
         for (auto &d : dirs)
         {
             int v = index(x + d[0], y + d[1]);
-            if (v < 0 || grid[u].walls[d[2]] || grid[v].blocked)
+            if (v < 0 || grid[u].walls[d[2]] || closed(v))
                 continue;
-            float w = 1.0f; // All edges have weight 1
+            float w = grid[v].cost;
             if (dist[v] > du + w)
             {
                 dist[v] = du + w;
                 parent[v] = u;
                 pushEvent(u, v, false, w);
                 pq.push({dist[v], v});
+                stats.edgesRelaxed++;
             }
         }
     }
@@ -160,15 +239,22 @@ void solveDijkstra()
         if (pathSet.count({u, v}))
             std::get<2>(e) = true;
     }
+    stats.pathLength = finalPathEdges.size();
+    stats.scratchBytes = N * (sizeof(float) + sizeof(int)) + stats.peakFrontier * sizeof(P);
+    stats.seconds = nowSeconds() - t0;
+    return stats;
 }
 
-void solveAStar()
+SolveStats solveAStar()
 {
+    TraceScope trace("solveAStar");
+    SolveStats stats;
+    double t0 = nowSeconds();
     auto h = [&](int a)
     {
         int ax = a % gCols, ay = a / gCols;
         int ex = endCell % gCols, ey = endCell / gCols;
-        return (float)(abs(ax - ex) + abs(ay - ey));
+        return (float)(abs(ax - ex) + abs(ay - ey)); // admissible: every cost is >= 1
     };
     int N = gCols * gRows;
     const float INF = std::numeric_limits<float>::infinity();
@@ -184,19 +270,24 @@ void solveAStar()
 
     while (!open.empty())
     {
+        stats.peakFrontier = std::max(stats.peakFrontier, open.size());
         auto [f, u] = open.top();
         open.pop();
         if (f != fScore[u])
+        {
+            stats.stalePops++;
             continue;
+        }
+        stats.nodesExpanded++;
         if (u == endCell)
             break;
         int x = u % gCols, y = u / gCols;
         for (auto &d : dirs)
         {
             int v = index(x + d[0], y + d[1]);
-            if (v < 0 || grid[u].walls[d[2]] || grid[v].blocked)
+            if (v < 0 || grid[u].walls[d[2]] || closed(v))
                 continue;
-            float w = 1.0f; // All edges have weight 1
+            float w = grid[v].cost;
             float tent = gScore[u] + w;
             if (tent < gScore[v])
             {
@@ -205,6 +296,7 @@ void solveAStar()
                 fScore[v] = tent + h(v);
                 pushEvent(u, v, false, w);
                 open.push({fScore[v], v});
+                stats.edgesRelaxed++;
             }
         }
     }
@@ -226,4 +318,242 @@ void solveAStar()
         if (pathSet.count({u, v}))
             std::get<2>(e) = true;
     }
-}
\ No newline at end of file
+    stats.pathLength = finalPathEdges.size();
+    stats.scratchBytes = N * (2 * sizeof(float) + sizeof(int)) + stats.peakFrontier * sizeof(P);
+    stats.seconds = nowSeconds() - t0;
+    return stats;
+}
+
+// ---- Delta-stepping: Dijkstra's distances with the frontier relaxed in parallel ----
+
+// Non-negative floats order like their bit patterns, so distances are atomic
+// uint32 lowered with a compare-exchange loop
+static inline uint32_t floatBits(float f)
+{
+    uint32_t b;
+    memcpy(&b, &f, sizeof(b));
+    return b;
+}
+
+static inline float bitsFloat(uint32_t b)
+{
+    float f;
+    memcpy(&f, &b, sizeof(f));
+    return f;
+}
+
+static bool lowerDistance(std::atomic<uint32_t> &slot, float d)
+{
+    uint32_t want = floatBits(d), cur = slot.load(std::memory_order_relaxed);
+    while (want < cur)
+        if (slot.compare_exchange_weak(cur, want, std::memory_order_relaxed))
+            return true;
+    return false;
+}
+
+// Buckets of width delta hold tentative distances. The lowest bucket is drained by
+// relaxing light edges (cost <= delta) of all its cells at once, repeating while
+// that re-fills it; heavy edges of everything settled there are relaxed once after.
+// Buckets are cyclic: live entries never span more than maxCost / delta buckets.
+SolveStats solveDeltaStepping()
+{
+    TraceScope trace("solveDeltaStepping");
+    SolveStats stats;
+    double t0 = nowSeconds();
+    int N = gCols * gRows;
+    static const int dirs[4][3] = {{0, -1, 0}, {1, 0, 1}, {0, 1, 2}, {-1, 0, 3}};
+    const float INF = std::numeric_limits<float>::infinity();
+
+    // Mean cost as the width: on flat terrain each bucket is exactly one BFS level
+    double costSum = 0.0;
+    float maxCost = 1.0f;
+    for (const Cell &c : grid)
+    {
+        costSum += c.cost;
+        maxCost = std::max(maxCost, c.cost);
+    }
+    const float delta = std::max(1.0f, (float)(costSum / std::max(N, 1)));
+    const int bucketSlots = (int)std::ceil(maxCost / delta) + 2;
+    auto bucketOf = [&](float d)
+    { return (int)(d / delta); };
+
+    std::unique_ptr<std::atomic<uint32_t>[]> dist(new std::atomic<uint32_t>[N]);
+    for (int i = 0; i < N; ++i)
+        dist[i].store(floatBits(INF), std::memory_order_relaxed);
+    auto distOf = [&](int v)
+    { return bitsFloat(dist[v].load(std::memory_order_relaxed)); };
+    std::vector<int> queuedIn(N, -1); // bucket a cell is filed under, so it is queued once
+    std::vector<std::vector<int>> buckets(bucketSlots);
+    std::vector<std::vector<int>> improved(workerCount() * 4);
+
+    // Relax one kind of edge out of `from` in parallel, then file every cell whose
+    // distance dropped under its new bucket. Small frontiers run inline.
+    auto relax = [&](const std::vector<int> &from, bool heavy)
+    {
+        int parts = (int)std::min<size_t>(improved.size(), (from.size() + 511) / 512);
+        parallelFor(parts, [&](int p)
+                    {
+            std::vector<int> &out = improved[p];
+            size_t lo = from.size() * p / parts, hi = from.size() * (p + 1) / parts;
+            for (size_t i = lo; i < hi; ++i)
+            {
+                int u = from[i], x = u % gCols, y = u / gCols;
+                float du = distOf(u);
+                for (auto &d : dirs)
+                {
+                    int v = index(x + d[0], y + d[1]);
+                    if (v < 0 || grid[u].walls[d[2]] || closed(v))
+                        continue;
+                    float w = grid[v].cost;
+                    if ((w > delta) == heavy && lowerDistance(dist[v], du + w))
+                        out.push_back(v);
+                }
+            } });
+        for (int p = 0; p < parts; ++p)
+        {
+            for (int v : improved[p])
+            {
+                stats.edgesRelaxed++;
+                int b = bucketOf(distOf(v));
+                if (queuedIn[v] != b)
+                {
+                    queuedIn[v] = b;
+                    buckets[b % bucketSlots].push_back(v);
+                }
+            }
+            improved[p].clear();
+        }
+    };
+
+    dist[startCell].store(floatBits(0.0f));
+    queuedIn[startCell] = 0;
+    buckets[0].push_back(startCell);
+    std::vector<int> frontier, settled, order; // order: cells by bucket, for the animation
+    for (int cur = 0;;)
+    {
+        int skip = 0;
+        while (skip < bucketSlots && buckets[(cur + skip) % bucketSlots].empty())
+            skip++;
+        if (skip == bucketSlots)
+            break;
+        cur += skip;
+        if (cur * delta > distOf(endCell))
+            break; // every cell below this bucket, end included, is final
+
+        settled.clear();
+        std::vector<int> &bucket = buckets[cur % bucketSlots];
+        while (!bucket.empty())
+        {
+            frontier.clear();
+            frontier.swap(bucket);
+            size_t keep = 0;
+            for (int v : frontier)
+            {
+                // moved to a lower bucket after it was queued here
+                if (queuedIn[v] != cur || bucketOf(distOf(v)) != cur)
+                {
+                    stats.stalePops++;
+                    continue;
+                }
+                queuedIn[v] = -1;
+                frontier[keep++] = v;
+            }
+            frontier.resize(keep);
+            stats.nodesExpanded += keep;
+            stats.peakFrontier = std::max(stats.peakFrontier, keep);
+            settled.insert(settled.end(), frontier.begin(), frontier.end());
+            relax(frontier, false);
+        }
+        relax(settled, true);
+        // a cell re-lowered inside its bucket is settled twice; keep it once
+        std::sort(settled.begin(), settled.end(), [&](int a, int b)
+                  { float da = distOf(a), db = distOf(b); return da != db ? da < db : a < b; });
+        settled.erase(std::unique(settled.begin(), settled.end()), settled.end());
+        order.insert(order.end(), settled.begin(), settled.end());
+    }
+
+    // Parents from the final distances: a neighbour whose distance plus the step
+    // cost reproduces this one exactly (the same float sum that set it)
+    float limit = distOf(endCell);
+    std::vector<int> parent(N, -1);
+    int parts = (int)std::min<size_t>(improved.size(), (order.size() + 4095) / 4096);
+    parallelFor(parts, [&](int p)
+                {
+        size_t lo = order.size() * p / parts, hi = order.size() * (p + 1) / parts;
+        for (size_t i = lo; i < hi; ++i)
+        {
+            int v = order[i], x = v % gCols, y = v / gCols;
+            float dv = distOf(v);
+            if (v == startCell || dv > limit)
+                continue;
+            for (auto &d : dirs)
+            {
+                int u = index(x + d[0], y + d[1]);
+                if (u >= 0 && !grid[v].walls[d[2]] && !closed(u) && distOf(u) + grid[v].cost == dv)
+                {
+                    parent[v] = u;
+                    break;
+                }
+            }
+        } });
+
+    finalPathEdges.clear();
+    std::vector<char> onPath(N, 0);
+    for (int cur = endCell; cur != -1 && parent[cur] != -1; cur = parent[cur])
+    {
+        finalPathEdges.emplace_back(parent[cur], cur);
+        onPath[cur] = 1;
+    }
+    std::reverse(finalPathEdges.begin(), finalPathEdges.end());
+    for (int v : order)
+        if (parent[v] != -1)
+            pushEvent(parent[v], v, onPath[v] != 0, grid[v].cost);
+    stats.pathLength = finalPathEdges.size();
+    stats.scratchBytes = N * (sizeof(uint32_t) + 2 * sizeof(int) + 1) + order.capacity() * sizeof(int);
+    stats.seconds = nowSeconds() - t0;
+    return stats;
+}
+
+SolveStats runSolver(int algo)
+{
+    // Start and end in different regions: no search, nothing to animate. The
+    // flow field already knows which cells reach the end, and its whole point is
+    // not redoing work over the grid when only start or end moved.
+    bool flow = algo == 8;
+    if (!flow && !cellsConnected(startCell, endCell))
+    {
+        finalPathEdges.clear();
+        logf("No path: start and end are in different regions");
+        return SolveStats();
+    }
+    skipCells = pruneDeadEnds && !flow ? currentDeadEndFill().sealed.data() : nullptr;
+    SolveStats stats = algo == 0   ? solveDFS()
+                       : algo == 1 ? solveBFS()
+                       : algo == 2 ? solveDijkstra()
+                       : algo == 3 ? solveAStar()
+                       : algo == 4 ? solveDeltaStepping()
+                       : algo == 5 ? solveHPA()
+                       : algo == 6 ? solveCH()
+                       : algo == 7 ? solveLPA()
+                                   : solveFlowField();
+    skipCells = nullptr;
+    traceCounter("nodes expanded", (double)stats.nodesExpanded);
+    traceCounter("peak frontier", (double)stats.peakFrontier);
+    return stats;
+}
+
+// Runs every solver on the current maze for comparison, leaving the
+// animation's events and final path untouched
+void measureAllSolvers(SolveStats out[SOLVER_COUNT])
+{
+    auto savedEvents = std::move(events);
+    auto savedPath = std::move(finalPathEdges);
+    for (int a = 0; a < SOLVER_COUNT; ++a)
+    {
+        events.clear();
+        finalPathEdges.clear();
+        out[a] = runSolver(a);
+    }
+    events = std::move(savedEvents);
+    finalPathEdges = std::move(savedPath);
+}
@@ -1,15 +1,30 @@
 #include "../headers/textures.h"
 #include "../headers/logging.h"
+#include "../headers/tracing.h"
 
-GLuint loadTexture(const char *path)
+GLuint texAtlas = 0;
+AtlasRect atlasRects[SPR_COUNT];
+
+static const char *spritePaths[SPR_COUNT] = {
+    "assets/splashScreen.png", // Splash screen
+    "assets/background.png",   // 1536x1024
+    "assets/start.png",        // 64x64
+    "assets/end.png",          // 64x64
+    "assets/obsticle.png",     // 64x64
+    "assets/lineHori.png",     // horizontal wall
+    "assets/lineVerti.png",    // vertical wall
+    "assets/play.png",
+    "assets/pause.png",
+    "assets/regen.png",
+    "assets/setting.png",
+    "assets/step.png"};
+
+static GLuint *spriteTextures[SPR_COUNT] = {
+    &texSplashScreen, &texBackground, &texStart, &texEnd, &texObstacle, &texLineHori,
+    &texLineVerti, &texPlay, &texPause, &texRegen, &texSettings, &texStep};
+
+static GLuint uploadRGBA(const unsigned char *data, int w, int h)
 {
-    int w = 0, h = 0, n = 0;
-    stbi_uc *data = stbi_load(path, &w, &h, &n, 4);
-    if (!data)
-    {
-        logf("Failed to load texture: %s", path);
-        return 0;
-    }
     GLuint id;
     glGenTextures(1, &id);
     glBindTexture(GL_TEXTURE_2D, id);
@@ -19,31 +34,133 @@ GLuint loadTexture(const char *path)
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return id;
+}
+
+GLuint loadTexture(const char *path)
+{
+    int w = 0, h = 0, n = 0;
+    stbi_uc *data = stbi_load(path, &w, &h, &n, 4);
+    if (!data)
+    {
+        logf("Failed to load texture: %s", path);
+        return 0;
+    }
+    GLuint id = uploadRGBA(data, w, h);
     stbi_image_free(data);
     logf("Loaded texture %s (%dx%d)", path, w, h);
     return id;
 }
 
+// Shelf packer: tallest images first, left to right, new shelf when a row is full.
+// Each image gets `pad` pixels of replicated edge so linear filtering never bleeds.
+static bool packAtlas(const int *w, const int *h, int count, int atlasW, int pad, int *xs, int *ys, int &atlasH)
+{
+    std::vector<int> order(count);
+    for (int i = 0; i < count; i++)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return h[a] > h[b]; });
+
+    int x = 0, y = 0, shelfH = 0;
+    for (int i : order)
+    {
+        if (w[i] == 0)
+            continue;
+        int pw = w[i] + 2 * pad, ph = h[i] + 2 * pad;
+        if (pw > atlasW)
+            return false;
+        if (x + pw > atlasW)
+        {
+            y += shelfH;
+            x = shelfH = 0;
+        }
+        xs[i] = x + pad;
+        ys[i] = y + pad;
+        x += pw;
+        shelfH = std::max(shelfH, ph);
+    }
+    atlasH = y + shelfH;
+    return true;
+}
+
 void loadAllTextures()
 {
-    texSplashScreen = loadTexture("assets/splashScreen.png"); // Splash screen
-    texBackground = loadTexture("assets/background.png"); // 1024x1024
-    texStart = loadTexture("assets/start.png");           // 64x64
-    texEnd = loadTexture("assets/end.png");               // 64x64
-    texObstacle = loadTexture("assets/obsticle.png");     // 64x64
-    texLineHori = loadTexture("assets/lineHori.png");     // horizontal wall
-    texLineVerti = loadTexture("assets/lineVerti.png");   // vertical wall
-    texWall = 0;                                          // legacy, not used
-    texPlay = loadTexture("assets/play.png");
-    texPause = loadTexture("assets/pause.png");
-    texRegen = loadTexture("assets/regen.png");
-    texSettings = loadTexture("assets/setting.png");
-    texStep = loadTexture("assets/step.png");
+    TraceScope trace("loadAllTextures");
+    stbi_uc *pixels[SPR_COUNT] = {};
+    int w[SPR_COUNT] = {}, h[SPR_COUNT] = {};
+    int maxW = 0;
+    for (int i = 0; i < SPR_COUNT; i++)
+    {
+        int n = 0;
+        pixels[i] = stbi_load(spritePaths[i], &w[i], &h[i], &n, 4);
+        if (!pixels[i])
+        {
+            logf("Failed to load texture: %s", spritePaths[i]);
+            w[i] = h[i] = 0;
+        }
+        maxW = std::max(maxW, w[i]);
+    }
+    texWall = 0; // legacy, not used
+
+    const int pad = 2;
+    GLint maxSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    int atlasW = 64;
+    while (atlasW < maxW + 2 * pad)
+        atlasW *= 2;
+    int xs[SPR_COUNT] = {}, ys[SPR_COUNT] = {}, atlasH = 0;
+    bool packed = packAtlas(w, h, SPR_COUNT, atlasW, pad, xs, ys, atlasH) && atlasW <= maxSize && atlasH <= maxSize;
+
+    if (packed)
+    {
+        std::vector<unsigned char> atlas((size_t)atlasW * atlasH * 4, 0);
+        for (int i = 0; i < SPR_COUNT; i++)
+        {
+            if (!pixels[i])
+                continue;
+            // copy with the border pixels clamped out into the padding
+            for (int y = -pad; y < h[i] + pad; y++)
+                for (int x = -pad; x < w[i] + pad; x++)
+                {
+                    int sx = std::clamp(x, 0, w[i] - 1), sy = std::clamp(y, 0, h[i] - 1);
+                    memcpy(&atlas[((size_t)(ys[i] + y) * atlasW + xs[i] + x) * 4], &pixels[i][((size_t)sy * w[i] + sx) * 4], 4);
+                }
+            atlasRects[i].uv0 = ImVec2((float)xs[i] / atlasW, (float)ys[i] / atlasH);
+            atlasRects[i].uv1 = ImVec2((float)(xs[i] + w[i]) / atlasW, (float)(ys[i] + h[i]) / atlasH);
+        }
+        texAtlas = uploadRGBA(atlas.data(), atlasW, atlasH);
+        for (int i = 0; i < SPR_COUNT; i++)
+            *spriteTextures[i] = pixels[i] ? texAtlas : 0;
+        logf("Packed %d textures into a %dx%d atlas", SPR_COUNT, atlasW, atlasH);
+    }
+    else
+    {
+        logf("Texture atlas does not fit (max %d), using separate textures", maxSize);
+        for (int i = 0; i < SPR_COUNT; i++)
+        {
+            atlasRects[i] = AtlasRect();
+            *spriteTextures[i] = pixels[i] ? uploadRGBA(pixels[i], w[i], h[i]) : 0;
+        }
+    }
+    for (int i = 0; i < SPR_COUNT; i++)
+        if (pixels[i])
+            stbi_image_free(pixels[i]);
 }
 
 void deleteAllTextures()
 {
-    GLuint ids[12] = {texSplashScreen, texBackground, texStart, texEnd, texObstacle, texLineHori, texLineVerti, texPlay, texPause, texRegen, texSettings, texStep};
-    glDeleteTextures(12, ids);
-    texSplashScreen = texBackground = texStart = texEnd = texObstacle = texLineHori = texLineVerti = texPlay = texPause = texRegen = texSettings = texStep = 0;
-}
\ No newline at end of file
+    if (texAtlas)
+    {
+        glDeleteTextures(1, &texAtlas);
+    }
+    else
+    {
+        GLuint ids[SPR_COUNT];
+        for (int i = 0; i < SPR_COUNT; i++)
+            ids[i] = *spriteTextures[i];
+        glDeleteTextures(SPR_COUNT, ids);
+    }
+    texAtlas = 0;
+    for (int i = 0; i < SPR_COUNT; i++)
+        *spriteTextures[i] = 0;
+}
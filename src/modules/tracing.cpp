@@ -0,0 +1,152 @@
+#include "../headers/tracing.h"
+#include "../headers/logging.h"
+#include <chrono>
+#include <memory>
+#include <mutex>
+
+std::atomic<bool> traceEnabled{false};
+
+struct TraceEvent
+{
+    const char *name;
+    uint64_t ns; // since traceEpoch
+    double value;
+    char phase; // 'B', 'E' or 'C'
+};
+
+// One buffer per thread that ever recorded. The owner takes its lock for each
+// append (uncontended except while writeTrace/traceClear walk the buffers).
+struct ThreadTrace
+{
+    std::mutex lock;
+    std::vector<TraceEvent> events;
+    const char *name = "thread";
+    int tid;
+};
+
+static const size_t maxEventsPerThread = size_t(1) << 22; // ~100 MB per thread at most
+static std::mutex registryMutex;
+static std::vector<std::unique_ptr<ThreadTrace>> threads; // kept after their thread exits
+static std::atomic<size_t> droppedEvents{0};
+static thread_local ThreadTrace *localTrace = nullptr;
+static const auto traceEpoch = std::chrono::steady_clock::now();
+
+static uint64_t nowNs()
+{
+    using namespace std::chrono;
+    return (uint64_t)duration_cast<nanoseconds>(steady_clock::now() - traceEpoch).count();
+}
+
+static ThreadTrace *threadBuffer()
+{
+    if (!localTrace)
+    {
+        std::lock_guard<std::mutex> lk(registryMutex);
+        threads.push_back(std::make_unique<ThreadTrace>());
+        localTrace = threads.back().get();
+        localTrace->tid = (int)threads.size();
+    }
+    return localTrace;
+}
+
+static void record(const char *name, char phase, double value)
+{
+    threadBuffer();
+    uint64_t ns = nowNs();
+    std::lock_guard<std::mutex> lk(localTrace->lock);
+    // An end is always kept so scopes opened before the cap still close
+    if (localTrace->events.size() >= maxEventsPerThread && phase != 'E')
+    {
+        droppedEvents++;
+        return;
+    }
+    localTrace->events.push_back({name, ns, value, phase});
+}
+
+void traceBegin(const char *name)
+{
+    if (traceEnabled.load(std::memory_order_relaxed))
+        record(name, 'B', 0.0);
+}
+
+// Not gated on traceEnabled: the matching begin decided whether this pair records
+void traceEnd(const char *name)
+{
+    record(name, 'E', 0.0);
+}
+
+void traceCounter(const char *name, double value)
+{
+    if (traceEnabled.load(std::memory_order_relaxed))
+        record(name, 'C', value);
+}
+
+void traceThreadName(const char *name)
+{
+    ThreadTrace *t = threadBuffer();
+    std::lock_guard<std::mutex> lk(t->lock);
+    t->name = name;
+}
+
+void traceClear()
+{
+    std::lock_guard<std::mutex> lk(registryMutex);
+    for (auto &t : threads)
+    {
+        std::lock_guard<std::mutex> tl(t->lock);
+        t->events.clear();
+    }
+    droppedEvents = 0;
+}
+
+size_t traceEventCount()
+{
+    std::lock_guard<std::mutex> lk(registryMutex);
+    size_t n = 0;
+    for (auto &t : threads)
+    {
+        std::lock_guard<std::mutex> tl(t->lock);
+        n += t->events.size();
+    }
+    return n;
+}
+
+// JSON object format; events stay grouped per thread, the viewers sort by ts
+bool writeTrace(const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f)
+    {
+        logAt(LL_ERROR, "cannot write trace %s", path);
+        return false;
+    }
+    size_t written = 0;
+    fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Maze\"}}");
+    {
+        std::lock_guard<std::mutex> lk(registryMutex);
+        for (auto &t : threads)
+        {
+            std::lock_guard<std::mutex> tl(t->lock);
+            fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s %d\"}}",
+                    t->tid, t->name, t->tid);
+            for (const TraceEvent &e : t->events)
+            {
+                fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%d",
+                        e.name, e.phase, e.ns * 1e-3, t->tid);
+                if (e.phase == 'C')
+                    fprintf(f, ",\"args\":{\"value\":%.17g}", e.value);
+                fputc('}', f);
+            }
+            written += t->events.size();
+        }
+    }
+    fprintf(f, "\n]}\n");
+    bool ok = !ferror(f);
+    ok = fclose(f) == 0 && ok;
+    if (!ok)
+        logAt(LL_ERROR, "error writing trace %s", path);
+    else
+        logf("trace: %zu events written to %s (%zu dropped)", written, path, droppedEvents.load());
+    return ok;
+}
@@ -0,0 +1,284 @@
+#include "../headers/tree_index.h"
+#include "../headers/components.h"
+#include "../headers/logging.h"
+#include "../headers/parallel.h"
+#include "../headers/parallel_bfs.h"
+#include "../headers/tracing.h"
+#include <chrono>
+
+// Landmark fields share this many distances (128 MB), with room for at least
+// minLandmarks of them; past that the index settles for tree distances
+static const size_t landmarkCells = (size_t)1 << 25;
+static const int minLandmarks = 32;
+
+static TreeIndexInfo info;
+static std::vector<int> depth, parent; // BFS tree from info.root, -1 outside it
+static std::vector<int> first;         // first position of each tree cell in the tour
+static std::vector<int> sparse;        // row k, column i: shallowest tour cell in [i, i + 2^k)
+static int tourLength = 0;
+static std::vector<std::vector<int>> landmarkDist;
+static unsigned int indexRevision = ~0u;
+static int indexCols = -1, indexRows = -1;
+
+static double nowSeconds()
+{
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+static int shallower(int a, int b)
+{
+    return depth[a] <= depth[b] ? a : b;
+}
+
+// Depth-first over the BFS tree's child lists, writing each cell on entry and
+// its parent again after every child returns: 2V - 1 entries
+static void buildTour(std::vector<int> &tour)
+{
+    const int N = gCols * gRows;
+    std::vector<int> childStart(N + 1, 0), children(std::max(0, info.cells - 1));
+    for (int u = 0; u < N; ++u)
+        if (parent[u] >= 0)
+            childStart[parent[u] + 1]++;
+    for (int u = 0; u < N; ++u)
+        childStart[u + 1] += childStart[u];
+    std::vector<int> fillAt(childStart.begin(), childStart.end() - 1);
+    for (int u = 0; u < N; ++u)
+        if (parent[u] >= 0)
+            children[fillAt[parent[u]]++] = u;
+
+    tour.clear();
+    tour.reserve(2 * info.cells - 1);
+    first.assign(N, -1);
+    std::vector<std::pair<int, int>> stack{{info.root, childStart[info.root]}};
+    first[info.root] = 0;
+    tour.push_back(info.root);
+    while (!stack.empty())
+    {
+        auto &top = stack.back();
+        if (top.second < childStart[top.first + 1])
+        {
+            int v = children[top.second++];
+            first[v] = (int)tour.size();
+            tour.push_back(v);
+            stack.push_back({v, childStart[v]});
+            continue;
+        }
+        stack.pop_back();
+        if (!stack.empty())
+            tour.push_back(stack.back().first);
+    }
+}
+
+// Row k combines two halves of row k - 1; each row is split over the workers
+static void buildSparse(const std::vector<int> &tour)
+{
+    const int T = tourLength;
+    info.levels = 1;
+    while ((1 << info.levels) <= T)
+        info.levels++;
+    sparse.resize((size_t)info.levels * T);
+    std::copy(tour.begin(), tour.end(), sparse.begin());
+    for (int k = 1; k < info.levels; ++k)
+    {
+        const int *prev = &sparse[(size_t)(k - 1) * T];
+        int *row = &sparse[(size_t)k * T];
+        int span = T - (1 << k) + 1, half = 1 << (k - 1);
+        int parts = std::max(1, std::min(workerCount() * 4, span / 4096));
+        parallelFor(parts, [&](int p)
+                    {
+            for (int i = (int)((long long)span * p / parts); i < (int)((long long)span * (p + 1) / parts); ++i)
+                row[i] = shallower(prev[i], prev[i + half]); });
+    }
+}
+
+// Open edges between tree cells that are not parent links
+static std::vector<int> loopEndpoints()
+{
+    const int C = gCols, N = gCols * gRows;
+    std::vector<char> endpoint(N, 0);
+    info.loopEdges = 0;
+    auto check = [&](int u, int v)
+    {
+        if (depth[v] < 0 || parent[v] == u || parent[u] == v)
+            return;
+        info.loopEdges++;
+        endpoint[u] = endpoint[v] = 1;
+    };
+    for (int u = 0; u < N; ++u)
+    {
+        if (depth[u] < 0)
+            continue;
+        if (u % C + 1 < C && openBetween(u, u + 1))
+            check(u, u + 1);
+        if (u + C < N && openBetween(u, u + C))
+            check(u, u + C);
+    }
+    std::vector<int> out;
+    for (int u = 0; u < N; ++u)
+        if (endpoint[u])
+            out.push_back(u);
+    return out;
+}
+
+static void buildIndex()
+{
+    TraceScope trace("buildTreeIndex");
+    double t0 = nowSeconds();
+    const int N = gCols * gRows;
+    info = TreeIndexInfo();
+    sparse.clear();
+    landmarkDist.clear();
+    tourLength = 0;
+    info.root = startCell >= 0 && startCell < N && !grid[startCell].blocked ? startCell : -1;
+    for (int u = 0; u < N && info.root < 0; ++u)
+        if (!grid[u].blocked)
+            info.root = u;
+    if (info.root < 0)
+    {
+        depth.assign(N, -1);
+        parent.assign(N, -1);
+        first.assign(N, -1);
+        info.seconds = nowSeconds() - t0;
+        return;
+    }
+
+    BfsField field;
+    bfsFieldParallel(info.root, field);
+    depth.swap(field.dist);
+    parent.swap(field.parent);
+    info.cells = (int)field.reached;
+
+    std::vector<int> tour;
+    buildTour(tour);
+    tourLength = (int)tour.size();
+    buildSparse(tour);
+
+    std::vector<int> ends = loopEndpoints();
+    info.budget = (int)std::max<size_t>(minLandmarks, landmarkCells / N);
+    if ((int)ends.size() <= info.budget)
+    {
+        // One sequential field per landmark, the landmarks spread over the workers
+        landmarkDist.resize(ends.size());
+        parallelFor((int)ends.size(), [&](int i)
+                    {
+            BfsField f;
+            bfsFieldSequential(ends[i], f);
+            landmarkDist[i].swap(f.dist); });
+        info.landmarks = (int)ends.size();
+        info.exact = true;
+    }
+    else
+        logf("Tree index: %zu loop endpoints over the budget of %d, distances are tree bounds",
+             ends.size(), info.budget);
+
+    info.bytes = (depth.size() + parent.size() + first.size() + sparse.size()) * sizeof(int) +
+                 (size_t)info.landmarks * N * sizeof(int);
+    info.seconds = nowSeconds() - t0;
+}
+
+const TreeIndexInfo &currentTreeIndex()
+{
+    if (indexRevision != mazeRevision || indexCols != gCols || indexRows != gRows)
+    {
+        buildIndex();
+        indexRevision = mazeRevision;
+        indexCols = gCols;
+        indexRows = gRows;
+    }
+    return info;
+}
+
+static bool inTree(int c)
+{
+    return c >= 0 && c < gCols * gRows && depth[c] >= 0;
+}
+
+int treeLca(int a, int b)
+{
+    currentTreeIndex();
+    if (!inTree(a) || !inTree(b))
+        return -1;
+    int i = first[a], j = first[b];
+    if (i > j)
+        std::swap(i, j);
+    int k = 31 - __builtin_clz((unsigned)(j - i + 1));
+    const int *row = &sparse[(size_t)k * tourLength];
+    return shallower(row[i], row[j - (1 << k) + 1]);
+}
+
+// Shortest of the tree path and the routes through each landmark; -1 picks the tree
+static int bestRoute(int a, int b, int &via)
+{
+    int l = treeLca(a, b);
+    via = -1;
+    if (l < 0)
+        return -1;
+    int best = depth[a] + depth[b] - 2 * depth[l];
+    for (int s = 0; s < info.landmarks; ++s)
+    {
+        int d = landmarkDist[s][a] + landmarkDist[s][b];
+        if (d < best)
+        {
+            best = d;
+            via = s;
+        }
+    }
+    return best;
+}
+
+int treeDistance(int a, int b)
+{
+    int via;
+    return bestRoute(a, b, via);
+}
+
+// Cells from `from` down a landmark field to its source: each step goes to an
+// open neighbour one closer, which exists on every cell the field reached
+static void descend(const std::vector<int> &dist, int from, std::vector<int> &out)
+{
+    static const int dirs[4][3] = {{0, -1, 0}, {1, 0, 1}, {0, 1, 2}, {-1, 0, 3}};
+    out.push_back(from);
+    for (int u = from; dist[u] > 0;)
+    {
+        int x = u % gCols, y = u / gCols;
+        for (auto &d : dirs)
+        {
+            int v = index(x + d[0], y + d[1]);
+            if (v >= 0 && !grid[u].walls[d[2]] && !grid[v].blocked && dist[v] == dist[u] - 1)
+            {
+                u = v;
+                break;
+            }
+        }
+        out.push_back(u);
+    }
+}
+
+bool treePath(int a, int b, std::vector<int> &cells)
+{
+    cells.clear();
+    int via;
+    if (bestRoute(a, b, via) < 0)
+        return false;
+    std::vector<int> back;
+    if (via >= 0)
+    {
+        descend(landmarkDist[via], a, cells);
+        descend(landmarkDist[via], b, back);
+    }
+    else
+    {
+        int l = treeLca(a, b);
+        for (int u = a; u != l; u = parent[u])
+            cells.push_back(u);
+        cells.push_back(l);
+        for (int u = b; u != l; u = parent[u])
+            back.push_back(u);
+    }
+    // back runs b -> meeting cell; the meeting cell is already in cells
+    if (via >= 0)
+        back.pop_back();
+    cells.insert(cells.end(), back.rbegin(), back.rend());
+    return true;
+}
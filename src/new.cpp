@@ -5,6 +5,19 @@
 #include "headers/maze_generation.h"
 #include "headers/solvers.h"
 #include "headers/rendering.h"
+#include "headers/frame_pacing.h"
+#include "headers/playback.h"
+#include "headers/profiler.h"
+#include "headers/tracing.h"
+#include "headers/maze_metrics.h"
+#include "headers/components.h"
+#include "headers/dead_ends.h"
+#include "headers/tree_index.h"
+#include "headers/hpa.h"
+#include "headers/contraction.h"
+#include "headers/lpa.h"
+#include "headers/flow_field.h"
+#include "headers/maze_file.h"
 
 int main()
 {
@@ -19,6 +32,18 @@ int main()
 #endif
     open_log();
 
+    // MAZE_TRACE=file records from startup (textures, first maze); otherwise the
+    // sidebar toggles recording and maze_trace.json is the default output
+    const char *tracePath = getenv("MAZE_TRACE");
+    traceEnabled = tracePath && *tracePath;
+    if (!traceEnabled)
+        tracePath = "maze_trace.json";
+    // Save/Load Maze in the sidebar use MAZE_FILE, maze.bin by default
+    const char *mazePath = getenv("MAZE_FILE");
+    if (!mazePath || !*mazePath)
+        mazePath = "maze.bin";
+    traceThreadName("main");
+
     // GLFW + Window
     glfwSetErrorCallback([](int c, const char *d)
                          { logf("GLFW error %d: %s", c, d); });
@@ -44,6 +69,7 @@ int main()
     glfwMakeContextCurrent(gWindow);
     glfwSwapInterval(1);
     glfwSetFramebufferSizeCallback(gWindow, framebuffer_size_callback);
+    installDamageCallbacks(gWindow); // before ImGui so its callbacks chain to ours
 
     // GLAD
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
@@ -111,10 +137,11 @@ int main()
         logf("Custom font set as default successfully");
     }
 
-    // (Shaders/VAOs kept, but not required for walls now)
+    // Walls are drawn instanced through this program (see drawWallsAsLines)
     shader = createProgram(VS_330, FS_330);
+    initRenderBuffers();
 
-    // Textures
+    // Textures (packed into one atlas, see textures.cpp)
     stbi_set_flip_vertically_on_load(false);
     loadAllTextures();
 
@@ -142,14 +169,24 @@ int main()
 
     // Initial maze
     regenerateMaze();
+    buildProjection();
 
     const double baseDelay = 0.005;
     double lastEventTime = 0.0;
+    bool wasAnimating = false;
 
     while (!glfwWindowShouldClose(gWindow))
     {
-        glfwPollEvents();
-        
+        // Block while the scene is static; input, animations and requestRedraw() wake us
+        bool animating = (solving && !stepMode) || splashScreenAnimating;
+        if (animating != wasAnimating)
+            requestRedraw(); // let the final animation state reach the screen
+        wasAnimating = animating;
+        if (!waitForFrame(animating))
+            continue;
+        profFrameBegin();
+
+
         // Handle splash screen click
         if (showSplashScreen && !splashScreenAnimating)
         {
@@ -184,12 +221,31 @@ int main()
         // Only draw game content if splash screen is not showing
         if (!showSplashScreen && !splashScreenAnimating)
         {
+            // 0) Camera (wheel zoom, right/middle drag pan over the maze)
+            profBegin(PROF_LAYER);
+            profGpuBegin(PROF_LAYER);
+            updateCamera();
+            // Shift+click toggles an obstacle; the region labels follow incrementally
+            if (!solving && ImGui::GetIO().KeyShift && ImGui::IsMouseClicked(0) && !ImGui::GetIO().WantCaptureMouse)
+            {
+                int c = cellUnderMouse();
+                if (c >= 0 && c != startCell && c != endCell)
+                    setCellBlocked(c, !grid[c].blocked);
+            }
+
             // 1) Background + assets
             drawTexturedLayer();
+            profGpuEnd(PROF_LAYER);
+            profEnd(PROF_LAYER);
 
             // 2) Maze walls (as lines) and dynamic paths – ABOVE background, BELOW UI windows
+            profBegin(PROF_WALLS);
             drawWallsAsLines();
+            profEnd(PROF_WALLS);
+            profBegin(PROF_PATHS);
             drawPathsAsLines();
+            profEnd(PROF_PATHS);
+            profBegin(PROF_UI);
 
         // -------- SIDE MENU UI --------
         // Custom white & purple theme for side menu
@@ -326,18 +382,46 @@ int main()
         ImGui::PushStyleColor(ImGuiCol_FrameBg, ImVec4(0.2f, 0.2f, 0.3f, 0.8f));
 
         ImGui::SetNextItemWidth(sliderWidth);
-        ImGui::SliderInt("##Cols", &uiCols, 5, 60);
+        ImGui::SliderInt("##Cols", &uiCols, 5, 1024, "%d", ImGuiSliderFlags_Logarithmic);
         ImGui::SameLine();
         ImGui::Text("Cols: %d", uiCols);
 
         ImGui::SetNextItemWidth(sliderWidth);
-        ImGui::SliderInt("##Rows", &uiRows, 5, 60);
+        ImGui::SliderInt("##Rows", &uiRows, 5, 1024, "%d", ImGuiSliderFlags_Logarithmic);
         ImGui::SameLine();
         ImGui::Text("Rows: %d", uiRows);
 
         ImGui::PopStyleColor(3);
         ImGui::PopStyleVar();
 
+        ImGui::Checkbox("Level of Detail", &lodEnabled);
+        if (currentLodLevel() >= 0)
+        {
+            ImGui::SameLine();
+            ImGui::TextDisabled("(mip %d)", currentLodLevel());
+        }
+        if (ImGui::SmallButton("Reset View"))
+            resetCamera();
+        ImGui::SameLine();
+        ImGui::TextDisabled("Zoom %.1fx (wheel, right-drag)", camZoom);
+        ImGui::TextDisabled("%.0f fps, CPU %.0f%%", frameStats().fps, frameStats().cpuPercent);
+        // Timers only run while this section is open
+        profilerEnabled = ImGui::CollapsingHeader("Profiler");
+        if (profilerEnabled)
+        {
+            drawProfilerPanel();
+            bool recording = traceEnabled;
+            if (ImGui::Checkbox("Record Trace", &recording))
+                traceEnabled = recording;
+            ImGui::SameLine();
+            if (ImGui::SmallButton("Save Trace"))
+                writeTrace(tracePath);
+            ImGui::SameLine();
+            if (ImGui::SmallButton("Clear##Trace"))
+                traceClear();
+            ImGui::TextDisabled("%zu events -> %s", traceEventCount(), tracePath);
+        }
+
         if ((uiCols != gCols) || (uiRows != gRows))
         {
             ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.2f, 0.8f, 0.3f, 0.9f));
@@ -345,12 +429,12 @@ int main()
             ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4(0.4f, 1.0f, 0.5f, 1.0f));
 
             float buttonWidth = availWidth.x * 0.9f;
-            if (texSettings && ImGui::ImageButton("settings", (ImTextureID)(intptr_t)texSettings, ImVec2(24, 24)))
+            if (texSettings && ImGui::ImageButton("settings", toImguiTex(texSettings), ImVec2(24, 24), atlasRects[SPR_SETTINGS].uv0, atlasRects[SPR_SETTINGS].uv1))
             {
                 gCols = uiCols;
                 gRows = uiRows;
                 regenerateMaze();
-                buildProjection();
+                resetCamera();
                 logf("Applied size C=%d R=%d", gCols, gRows);
             }
             ImGui::SameLine();
@@ -370,12 +454,13 @@ int main()
         ImGui::Combo("##GenAlgo", &genAlgo, genNames, IM_ARRAYSIZE(genNames));
         ImGui::PopStyleColor();
         ImGui::PopStyleVar();
+        ImGui::Checkbox("Perfect Maze (no loops)", &perfectMazes);
 
         ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.9f, 0.6f, 0.2f, 0.9f));
         ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(1.0f, 0.7f, 0.3f, 1.0f));
         ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4(1.0f, 0.8f, 0.4f, 1.0f));
 
-        if (texRegen && ImGui::ImageButton("regen", (ImTextureID)(intptr_t)texRegen, ImVec2(24, 24)))
+        if (texRegen && ImGui::ImageButton("regen", toImguiTex(texRegen), ImVec2(24, 24), atlasRects[SPR_REGEN].uv0, atlasRects[SPR_REGEN].uv1))
         {
             regenerateMaze();
             logf("Regenerated with algo %d", genAlgo);
@@ -388,6 +473,17 @@ int main()
             pickStartEnd();
         }
         ImGui::PopStyleColor(3);
+        if (ImGui::SmallButton("Save Maze"))
+            saveMaze(mazePath);
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Load Maze") && loadMaze(mazePath))
+        {
+            uiCols = gCols;
+            uiRows = gRows;
+            resetCamera();
+        }
+        ImGui::SameLine();
+        ImGui::TextDisabled("%s", mazePath);
 
         ImGui::SetCursorPosY(ImGui::GetCursorPosY() + 25);
         // Obstacles controls section
@@ -419,13 +515,39 @@ int main()
             clearObstacles();
         }
         ImGui::PopStyleColor(2);
+        ImGui::TextDisabled("%d regions, end %s (shift+click toggles a cell)", componentCount(),
+                            cellsConnected(startCell, endCell) ? "reachable" : "cut off");
+
+        // Terrain costs: every solver but DFS and BFS weighs them
+        ImGui::PushStyleVar(ImGuiStyleVar_FrameRounding, 10.0f);
+        ImGui::PushStyleColor(ImGuiCol_FrameBg, ImVec4(0.2f, 0.2f, 0.3f, 0.8f));
+        ImGui::SetNextItemWidth(sliderWidth);
+        ImGui::SliderFloat("##TerrainCost", &terrainMaxCost, 2.0f, 20.0f, "%.0f");
+        ImGui::SameLine();
+        ImGui::Text("Max cost: %.0f", terrainMaxCost);
+        ImGui::PopStyleColor();
+        ImGui::PopStyleVar();
+        ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.55f, 0.45f, 0.3f, 0.9f));
+        ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.65f, 0.55f, 0.4f, 1.0f));
+        if (ImGui::Button("Random Terrain", ImVec2(buttonWidth, 32)))
+        {
+            randomizeTerrain(terrainMaxCost);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Flat", ImVec2(buttonWidth, 32)))
+        {
+            clearTerrain();
+        }
+        ImGui::PopStyleColor(2);
 
         ImGui::SetCursorPosY(ImGui::GetCursorPosY() + 25);
 
         // Solving controls section
         drawSectionHeader("🧠", "PATHFINDING SOLVER", IM_COL32(120, 170, 220, 255));
 
-        const char *solveNames[] = {"Depth-First Search", "Breadth-First Search", "Dijkstra's Algorithm", "A* Algorithm"};
+        const char *solveNames[] = {"Depth-First Search", "Breadth-First Search", "Dijkstra's Algorithm", "A* Algorithm",
+                                    "Delta-Stepping (parallel)", "HPA* (clusters)",
+                                    "Contraction Hierarchy", "LPA* (incremental)", "Flow Field (from end)"};
         ImGui::PushStyleVar(ImGuiStyleVar_FrameRounding, 10.0f);
         ImGui::PushStyleColor(ImGuiCol_FrameBg, ImVec4(0.2f, 0.2f, 0.3f, 0.8f));
         ImGui::SetNextItemWidth(availWidth.x * 0.9f);
@@ -442,7 +564,129 @@ int main()
 
         ImGui::PushStyleColor(ImGuiCol_CheckMark, ImVec4(0.5f, 0.9f, 1.0f, 1.0f));
         ImGui::Checkbox("Step Mode", &stepMode);
+        ImGui::SameLine();
+        ImGui::Checkbox("Skip Dead Ends", &pruneDeadEnds);
         ImGui::PopStyleColor();
+        if (pruneDeadEnds)
+        {
+            const DeadEndFill &fill = currentDeadEndFill();
+            ImGui::TextDisabled("%d of %d open cells on viable routes (%.1f ms)", fill.viableCells, fill.openCells,
+                                fill.seconds * 1000.0);
+        }
+        if (solveAlgo == 5)
+        {
+            const HpaInfo &hpa = currentHpa();
+            ImGui::TextDisabled("HPA*: %d clusters, %d entrance nodes; last update %d clusters in %.1f ms", hpa.clusters,
+                                hpa.nodes, hpa.rebuilt, hpa.seconds * 1000.0);
+        }
+        // Not built from here: edits would rebuild the whole hierarchy every frame
+        if (solveAlgo == 6 && contractionCurrent())
+        {
+            const ChInfo &ch = currentContraction();
+            ImGui::TextDisabled("CH: %zu shortcuts, %.1f MB, %s in %.2f s", ch.shortcuts, ch.bytes / 1048576.0,
+                                ch.loaded ? "loaded" : "built", ch.seconds);
+        }
+        else if (solveAlgo == 6)
+            ImGui::TextDisabled("CH: built on the next solve");
+        if (solveAlgo == 7)
+        {
+            const LpaInfo &lpa = lastLpa();
+            if (lpa.fresh)
+                ImGui::TextDisabled("LPA*: last solve planned from scratch in %.2f ms", lpa.seconds * 1000.0);
+            else
+                ImGui::TextDisabled("LPA*: last solve repaired %d changed cells in %.2f ms", lpa.changedCells,
+                                    lpa.seconds * 1000.0);
+        }
+        // Not built from here either; the next solve reuses it if only start or end moved
+        if (solveAlgo == 8 && flowFieldCurrent())
+        {
+            const FlowInfo &flow = currentFlowField();
+            ImGui::TextDisabled("Flow field: %d cells reach the end, %.1f MB, built in %.1f ms", flow.reached,
+                                flow.bytes / 1048576.0, flow.seconds * 1000.0);
+        }
+        else if (solveAlgo == 8)
+            ImGui::TextDisabled("Flow field: checked on the next solve");
+
+        // Real solver cost (not the animation time), one column per algorithm
+        static SolveStats solveStats[SOLVER_COUNT];
+        if (ImGui::CollapsingHeader("Solve Stats"))
+        {
+            if (ImGui::SmallButton("Measure All"))
+                measureAllSolvers(solveStats);
+            if (ImGui::BeginTable("##SolveStats", SOLVER_COUNT + 1, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+            {
+                ImGui::TableSetupColumn("");
+                for (int a = 0; a < SOLVER_COUNT; ++a)
+                    ImGui::TableSetupColumn(solverNames[a]);
+                ImGui::TableHeadersRow();
+                auto statRow = [&](const char *label, const char *fmt, double (*get)(const SolveStats &))
+                {
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(label);
+                    for (int a = 0; a < SOLVER_COUNT; ++a)
+                    {
+                        ImGui::TableNextColumn();
+                        if (solveStats[a].nodesExpanded)
+                            ImGui::Text(fmt, get(solveStats[a]));
+                    }
+                };
+                statRow("ms", "%.3f", [](const SolveStats &s) { return s.seconds * 1000.0; });
+                statRow("expanded", "%.0f", [](const SolveStats &s) { return (double)s.nodesExpanded; });
+                statRow("relaxed", "%.0f", [](const SolveStats &s) { return (double)s.edgesRelaxed; });
+                statRow("peak open", "%.0f", [](const SolveStats &s) { return (double)s.peakFrontier; });
+                statRow("stale pops", "%.0f", [](const SolveStats &s) { return (double)s.stalePops; });
+                statRow("path", "%.0f", [](const SolveStats &s) { return (double)s.pathLength; });
+                statRow("scratch KB", "%.1f", [](const SolveStats &s) { return s.scratchBytes / 1024.0; });
+                ImGui::EndTable();
+            }
+        }
+
+        if (ImGui::CollapsingHeader("Maze Metrics"))
+        {
+            // Recomputed only after the maze changes
+            static MazeMetrics metrics;
+            static unsigned int metricsRevision = ~0u;
+            if (metricsRevision != mazeRevision)
+            {
+                metrics = computeMazeMetrics();
+                metricsRevision = mazeRevision;
+            }
+            ImGui::Text("Dead ends %d, junctions %d", metrics.deadEnds, metrics.junctions);
+            ImGui::Text("Degree 0-4: %d / %d / %d / %d / %d", metrics.degreeCount[0], metrics.degreeCount[1],
+                        metrics.degreeCount[2], metrics.degreeCount[3], metrics.degreeCount[4]);
+            ImGui::Text("Corridors %d, mean %.1f, longest %d", metrics.corridors, metrics.meanCorridor,
+                        metrics.longestCorridor);
+            float hist[METRIC_HIST_BUCKETS];
+            int buckets = 1;
+            for (int b = 0; b < METRIC_HIST_BUCKETS; ++b)
+            {
+                hist[b] = (float)metrics.corridorHist[b];
+                if (metrics.corridorHist[b])
+                    buckets = b + 1;
+            }
+            ImGui::PlotHistogram("##CorridorHist", hist, buckets, 0, "corridor length (log2)", 0.0f, FLT_MAX,
+                                 ImVec2(availWidth.x * 0.9f, 50));
+            ImGui::Text("Loops %lld, reachable %d", metrics.loops, metrics.reachable);
+            ImGui::Text("Start eccentricity %d, start-end %d", metrics.startEccentricity, metrics.endDistance);
+            ImGui::TextDisabled("computed in %.2f ms", metrics.seconds * 1000.0);
+        }
+
+        if (ImGui::CollapsingHeader("Tree Index"))
+        {
+            const TreeIndexInfo &ti = currentTreeIndex();
+            ImGui::Text("%d cells, %d loop edges, %s", ti.cells, ti.loopEdges,
+                        ti.exact ? "exact" : "tree bounds");
+            ImGui::TextDisabled("%d of %d landmarks, %.1f MB, built in %.2f ms", ti.landmarks, ti.budget,
+                                ti.bytes / 1048576.0, ti.seconds * 1000.0);
+            int c = cellUnderMouse(), d = c >= 0 ? treeDistance(startCell, c) : -1;
+            if (d >= 0 && ti.exact)
+                ImGui::Text("Start to cursor: %d steps", d);
+            else if (d >= 0)
+                ImGui::Text("Start to cursor: <= %d steps (bounds only)", d);
+            else
+                ImGui::TextDisabled("Hover a reachable cell for its distance from start");
+        }
 
         if (solving)
         {
@@ -462,6 +706,21 @@ int main()
             ImGui::SetCursorPosY(ImGui::GetCursorPosY() + 5);
         }
 
+        // Timeline scrubber: seeks through keyframes instead of replaying from zero
+        if (playbackReady())
+        {
+            int idx = (int)eventIndex;
+            ImGui::SetNextItemWidth(availWidth.x * 0.9f);
+            if (ImGui::SliderInt("##Timeline", &idx, 0, (int)events.size(), "Event %d"))
+            {
+                solving = false; // scrubbing pauses auto-play
+                seekPlayback((size_t)idx);
+                animState = eventIndex >= events.size() ? 1 : 0;
+                if (animState == 1)
+                    animEndTime = glfwGetTime();
+            }
+        }
+
         ImGui::SetCursorPosY(ImGui::GetCursorPosY() + 20);
 
         if (!solving && animState == 0)
@@ -472,21 +731,25 @@ int main()
             ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4(0.5f, 1.0f, 0.5f, 1.0f));
 
             float playButtonWidth = availWidth.x * 0.9f;
-            if (texPlay && ImGui::ImageButton("play", (ImTextureID)(intptr_t)texPlay, ImVec2(32, 32)))
+            if (texPlay && ImGui::ImageButton("play", toImguiTex(texPlay), ImVec2(32, 32), atlasRects[SPR_PLAY].uv0, atlasRects[SPR_PLAY].uv1))
             {
-                resetAnimationBuffers();
-                animStartTime = glfwGetTime();
-                lastEventTime = animStartTime;
-                if (solveAlgo == 0)
-                    solveDFS();
-                else if (solveAlgo == 1)
-                    solveBFS();
-                else if (solveAlgo == 2)
-                    solveDijkstra();
+                if (playbackCanResume())
+                {
+                    // paused or scrubbed mid-run: continue from the timeline position
+                    lastEventTime = glfwGetTime();
+                    solving = true;
+                    logf("Resumed at event %zu", eventIndex);
+                }
                 else
-                    solveAStar();
-                solving = true;
-                logf("Solve started with algo %d", solveAlgo);
+                {
+                    resetAnimationBuffers();
+                    animStartTime = glfwGetTime();
+                    lastEventTime = animStartTime;
+                    solveStats[solveAlgo] = runSolver(solveAlgo);
+                    buildPlaybackTimeline();
+                    solving = true;
+                    logf("Solve started with algo %d", solveAlgo);
+                }
             }
             ImGui::SameLine();
             ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.9f, 1.0f, 0.9f, 1.0f));
@@ -501,7 +764,7 @@ int main()
             ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.9f, 0.6f, 0.4f, 1.0f));
             ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4(1.0f, 0.7f, 0.5f, 1.0f));
 
-            if (texPause && ImGui::ImageButton("pause", (ImTextureID)(intptr_t)texPause, ImVec2(32, 32)))
+            if (texPause && ImGui::ImageButton("pause", toImguiTex(texPause), ImVec2(32, 32), atlasRects[SPR_PAUSE].uv0, atlasRects[SPR_PAUSE].uv1))
             {
                 solving = false;
                 logf("Paused");
@@ -518,19 +781,11 @@ int main()
                 ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.6f, 0.6f, 0.9f, 1.0f));
                 ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4(0.7f, 0.7f, 1.0f, 1.0f));
 
-                if (texStep && ImGui::ImageButton("step", (ImTextureID)(intptr_t)texStep, ImVec2(32, 32)))
+                if (texStep && ImGui::ImageButton("step", toImguiTex(texStep), ImVec2(32, 32), atlasRects[SPR_STEP].uv0, atlasRects[SPR_STEP].uv1))
                 {
                     if (eventIndex < events.size())
                     {
-                        auto [u, v, ok, wCost] = events[eventIndex++];
-                        if (ok)
-                            pushSuccess(u, v);
-                        else
-                        {
-                            if ((solveAlgo == 0) && successVertices.size() >= 4)
-                                successVertices.erase(successVertices.end() - 4, successVertices.end());
-                            pushFailure(u, v);
-                        }
+                        applyNextEvent();
                         if (eventIndex >= events.size())
                         {
                             animState = 1;
@@ -553,15 +808,7 @@ int main()
                 while (eventIndex < events.size() &&
                        (ct - lastEventTime) >= (baseDelay / speedMultiplier))
                 {
-                    auto [u, v, ok, wCost] = events[eventIndex++];
-                    if (ok)
-                        pushSuccess(u, v);
-                    else
-                    {
-                        if ((solveAlgo == 0) && successVertices.size() >= 4)
-                            successVertices.erase(successVertices.end() - 4, successVertices.end());
-                        pushFailure(u, v);
-                    }
+                    applyNextEvent();
                     lastEventTime += (baseDelay / speedMultiplier);
                     ct = glfwGetTime();
                 }
@@ -611,6 +858,8 @@ int main()
             {
                 successVertices.clear();
                 failureVertices.clear();
+                successSynced = failureSynced = 0;
+                invalidatePlayback();
             }
             ImGui::PopStyleColor(2);
         }
@@ -636,9 +885,9 @@ int main()
 
         // -------- THEMED OUTER BACKGROUND --------
         // Draw a purple gradient or color on the area outside the maze
-        float xoff, yoff, cell;
+        float xoff, yoff;
         int sz;
-        computeViewportAndCell(xoff, yoff, cell, sz);
+        computeMazeSquare(xoff, yoff, sz);
         ImDrawList *bg = ImGui::GetBackgroundDrawList();
         ImVec2 vp0 = ImGui::GetMainViewport()->Pos;
         ImVec2 vp1 = ImVec2(vp0.x + ImGui::GetMainViewport()->Size.x, vp0.y + ImGui::GetMainViewport()->Size.y);
@@ -662,21 +911,34 @@ int main()
         bg->AddRectFilledMultiColor(
             ImVec2(xoff, yoff + sz), ImVec2(xoff + sz, vp1.y),
             grad2, grad1, grad2, grad1);
+        profEnd(PROF_UI);
         } // End of game content conditional block
 
+        profBegin(PROF_IMGUI_RENDER);
         ImGui::Render();
+        profEnd(PROF_IMGUI_RENDER);
+        profBegin(PROF_GL_RENDER);
+        profGpuBegin(PROF_GL_RENDER);
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        profGpuEnd(PROF_GL_RENDER);
+        profEnd(PROF_GL_RENDER);
 
         glfwSwapBuffers(gWindow);
+        profFrameEnd(ImGui::GetDrawData());
     }
 
     // shutdown
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
+    deleteRenderBuffers();
+    deleteProfiler();
     deleteAllTextures();
     glfwDestroyWindow(gWindow);
     glfwTerminate();
+    if (traceEventCount())
+        writeTrace(tracePath);
     logf("Exited cleanly");
+    close_log();
     return 0;
 }
\ No newline at end of file